@@ -0,0 +1,87 @@
+/*
+ * Bulk booking: N makeReservation calls against one makeReservations batch,
+ * journaled with fsync on every commit. Writes into ./data, so run it from a
+ * scratch directory:
+ *
+ *   g++ -std=c++17 -O2 -pthread -o batch_booking bench/batch_booking.cpp \
+ *       main/AirlineSystem.cpp main/FileManager.cpp main/Passenger.cpp main/Flight.cpp \
+ *       main/Reservation.cpp main/CsvReader.cpp main/CsvWriter.cpp main/MappedFile.cpp \
+ *       main/ThreadPool.cpp main/TrigramIndex.cpp main/InputValidator.cpp main/IdAllocator.cpp \
+ *       main/ReservationColumns.cpp main/FilterKernels.cpp main/LocalTime.cpp
+ *   mkdir -p /tmp/bench && cd /tmp/bench && /path/to/batch_booking [bookings]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../main/AirlineSystem.h"
+
+namespace {
+
+template <typename F>
+double secondsFor(F run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, size_t bookings, double seconds) {
+    std::cout << std::left << std::setw(10) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(3) << seconds << " s"
+              << std::setw(14) << std::setprecision(0) << bookings / seconds << " reservations/s\n";
+}
+
+// A fresh system with one funded passenger and enough flights for `bookings`
+std::vector<ReservationRequest> prepare(AirlineSystem& system, int bookings) {
+    system.setDurability(Durability::Fsync);
+    system.setJournaling(true, 1000000);
+    time_t departure = std::time(nullptr) + 30 * 24 * 60 * 60;
+    int passenger = system.addPassenger(Passenger("Bench Doe", "BB1234567", "1234567890", "IRN"));
+    system.updateWalletBalance(passenger, 1e12);
+    std::vector<int> flights;
+    for (int f = 0; f < 20; ++f) {
+        flights.push_back(system.addFlight(Flight("BB" + std::to_string(f), "Tehran", "Yazd",
+                                                  departure, bookings / 20 + 1, 10.0)));
+    }
+    std::vector<ReservationRequest> requests;
+    for (int i = 0; i < bookings; ++i) {
+        requests.push_back({passenger, flights[i % flights.size()]});
+    }
+    return requests;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int bookings = argc > 1 ? std::atoi(argv[1]) : 500;
+
+    std::filesystem::remove_all("data");
+    double single;
+    {
+        AirlineSystem system;
+        auto requests = prepare(system, bookings);
+        single = secondsFor([&]() {
+            for (const auto& request : requests) {
+                system.makeReservation(request.passenger_id, request.flight_id);
+            }
+        });
+    }
+
+    std::filesystem::remove_all("data");
+    double batched;
+    {
+        AirlineSystem system;
+        auto requests = prepare(system, bookings);
+        batched = secondsFor([&]() { system.makeReservations(requests); });
+    }
+
+    std::cout << "Booking " << bookings << " reservations\n";
+    report("single", bookings, single);
+    report("batch", bookings, batched);
+    std::cout << "speedup   " << std::setprecision(1) << single / batched << "x\n";
+    return 0;
+}
@@ -0,0 +1,66 @@
+/*
+ * Bulk import throughput: generates passenger and flight CSV files and times
+ * AirlineSystem::importPassengers / importFlights, each a single commit.
+ * Writes into ./data, so run it from a scratch directory:
+ *
+ *   g++ -std=c++17 -O2 -pthread -o import_benchmark bench/import_benchmark.cpp \
+ *       main/AirlineSystem.cpp main/FileManager.cpp main/Passenger.cpp main/Flight.cpp \
+ *       main/Reservation.cpp main/CsvReader.cpp main/CsvWriter.cpp main/MappedFile.cpp \
+ *       main/ThreadPool.cpp main/TrigramIndex.cpp main/InputValidator.cpp main/IdAllocator.cpp \
+ *       main/ReservationColumns.cpp main/FilterKernels.cpp main/LocalTime.cpp
+ *   mkdir -p /tmp/bench && cd /tmp/bench && /path/to/import_benchmark [rows]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include "../main/AirlineSystem.h"
+
+namespace {
+
+template <typename F>
+double secondsFor(F run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, const ImportReport& result, double seconds) {
+    std::cout << std::left << std::setw(12) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(3) << seconds << " s"
+              << std::setw(14) << std::setprecision(0) << result.imported / seconds * 60 << " rows/min"
+              << std::setw(8) << result.rejected.size() << " rejected\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::filesystem::remove_all("data");
+
+    {
+        std::ofstream passengers("bench_passengers.csv");
+        std::ofstream flights("bench_flights.csv");
+        time_t departure = std::time(nullptr) + 30 * 24 * 60 * 60;
+        for (size_t i = 0; i < rows; ++i) {
+            passengers << "Passenger " << i << ",P" << 10000000 + i << "," << 1000000000 + i << ",IRN\n";
+            flights << "IR" << 1000 + i % 9000 << ",Tehran,City" << i % 50 << ","
+                    << departure + static_cast<time_t>(i * 60) << ",180," << 50 + i % 400 << "\n";
+        }
+    }
+
+    AirlineSystem system;
+    ImportReport passengers, flights;
+    double passenger_seconds = secondsFor([&]() { passengers = system.importPassengers("bench_passengers.csv"); });
+    double flight_seconds = secondsFor([&]() { flights = system.importFlights("bench_flights.csv"); });
+
+    std::cout << "Importing " << rows << " rows per table\n";
+    report("passengers", passengers, passenger_seconds);
+    report("flights", flights, flight_seconds);
+    return 0;
+}
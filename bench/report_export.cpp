@@ -0,0 +1,73 @@
+/*
+ * Report export scaling: formats N reservation-style CSV rows through
+ * writeOrdered with 1, 2, 4, ... workers, checks every output is identical to
+ * the sequential one and times each run. Writes report_export.csv into the
+ * current directory:
+ *
+ *   g++ -std=c++17 -O2 -pthread -o report_export bench/report_export.cpp main/ThreadPool.cpp \
+ *       main/LocalTime.cpp
+ *   mkdir -p /tmp/bench && cd /tmp/bench && /path/to/report_export [max_threads] [rows]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "../main/OrderedOutput.h"
+#include "../main/LocalTime.h"
+
+namespace {
+
+void formatRows(std::ostream& out, size_t begin, size_t end, time_t base) {
+    for (size_t i = begin; i < end; ++i) {
+        char date_str[11];
+        LocalTime::formatDate(base + static_cast<time_t>(i % 100000) * 60, date_str);
+        out << i + 1 << ",Passenger " << i % 5000 << ",IR" << 1000 + i % 800 << ","
+            << date_str << "," << (i % 7 == 0 ? "Refunded" : "Future") << "," << 100.0 + (i % 50) / 4.0 << "\n";
+    }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    size_t max_threads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : hardware;
+    size_t rows = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2000000;
+    time_t base = std::time(nullptr);
+    auto format = [base](std::ostream& out, size_t begin, size_t end) { formatRows(out, begin, end, base); };
+
+    std::ostringstream reference;
+    writeOrdered(reference, nullptr, rows, format);
+
+    std::cout << "Exporting " << rows << " rows (" << hardware << " hardware threads)\n";
+    double single = 0;
+    for (size_t threads = 1; threads <= max_threads; threads *= 2) {
+        ThreadPool pool(threads);
+        auto start = std::chrono::steady_clock::now();
+        {
+            std::ofstream file("report_export.csv", std::ios::trunc);
+            writeOrdered(file, &pool, rows, format);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::ifstream written("report_export.csv", std::ios::binary);
+        std::stringstream content;
+        content << written.rdbuf();
+        if (content.str() != reference.str()) {
+            std::cerr << "output with " << threads << " threads differs from the sequential export\n";
+            return 1;
+        }
+
+        if (threads == 1) single = seconds;
+        std::cout << std::setw(3) << threads << " threads"
+                  << std::setw(10) << std::fixed << std::setprecision(3) << seconds << " s"
+                  << std::setw(8) << std::setprecision(2) << single / seconds << "x\n";
+    }
+    return 0;
+}
@@ -0,0 +1,91 @@
+/*
+ * Nightly report suite: the four reservation exports, the future flights export
+ * and a few flight passenger lists, written one call at a time and then as one
+ * generateReports batch. Writes into ./data and the current directory, so run it
+ * from a scratch directory:
+ *
+ *   g++ -std=c++17 -O2 -pthread -o report_suite bench/report_suite.cpp \
+ *       main/AirlineSystem.cpp main/FileManager.cpp main/Passenger.cpp main/Flight.cpp \
+ *       main/Reservation.cpp main/CsvReader.cpp main/CsvWriter.cpp main/MappedFile.cpp \
+ *       main/ThreadPool.cpp main/TrigramIndex.cpp main/InputValidator.cpp main/IdAllocator.cpp \
+ *       main/ReservationColumns.cpp main/FilterKernels.cpp main/LocalTime.cpp
+ *   mkdir -p /tmp/bench && cd /tmp/bench && /path/to/report_suite [reservations]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../main/AirlineSystem.h"
+
+namespace {
+
+template <typename F>
+double secondsFor(F run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int bookings = argc > 1 ? std::atoi(argv[1]) : 500000;
+    std::filesystem::remove_all("data");
+
+    AirlineSystem system;
+    system.setJournaling(true, 1000000);
+    time_t departure = std::time(nullptr) + 30 * 24 * 60 * 60;
+    std::vector<int> passengers;
+    for (int p = 0; p < 1000; ++p) {
+        std::string digits = std::to_string(1000000000 + p);
+        passengers.push_back(system.addPassenger(Passenger("Suite Doe", "SU" + digits.substr(3), digits, "IRN")));
+        system.updateWalletBalance(passengers.back(), 1e12);
+    }
+    std::vector<int> flights;
+    for (int f = 0; f < 200; ++f) {
+        flights.push_back(system.addFlight(Flight("SU" + std::to_string(100 + f), "Tehran", "Mashhad",
+                                                  departure + f * 3600, bookings / 200 + 1, 10.0)));
+    }
+    std::vector<ReservationRequest> requests;
+    for (int i = 0; i < bookings; ++i) {
+        requests.push_back({passengers[i % passengers.size()], flights[i % flights.size()]});
+    }
+    system.makeReservations(requests);
+
+    std::vector<ReportSpec> suite = {ReportSpec::reservations("all.csv"),
+                                     ReportSpec::reservations("future.csv", true, false, false),
+                                     ReportSpec::reservations("completed.csv", false, true, false),
+                                     ReportSpec::reservations("refunded.csv", false, false, true),
+                                     ReportSpec::futureFlights("future_flights.csv")};
+    for (int f = 0; f < 5; ++f) {
+        suite.push_back(ReportSpec::flightPassengers("flight_" + std::to_string(f) + ".csv", flights[f]));
+    }
+
+    double separate = secondsFor([&]() {
+        for (const auto& spec : suite) {
+            switch (spec.kind) {
+                case ReportSpec::Kind::Reservations:
+                    system.generateReservationsReport(spec.filename, spec.future_only, spec.completed_only,
+                                                      spec.refunded_only);
+                    break;
+                case ReportSpec::Kind::FutureFlights:
+                    system.generateFutureFlightsReport(spec.filename);
+                    break;
+                case ReportSpec::Kind::FlightPassengers:
+                    system.generateFlightPassengersReport(spec.filename, spec.flight_id);
+                    break;
+            }
+        }
+    });
+    double batched = secondsFor([&]() { system.generateReports(suite); });
+
+    std::cout << "Report suite of " << suite.size() << " reports over " << bookings << " reservations\n"
+              << "separate " << std::fixed << std::setprecision(3) << std::setw(10) << separate << " s\n"
+              << "batched  " << std::setw(10) << batched << " s\n"
+              << "speedup  " << std::setprecision(2) << std::setw(10) << separate / batched << "x\n";
+    return 0;
+}
@@ -0,0 +1,76 @@
+/*
+ * Booking throughput against thread count. Every thread books its own passenger
+ * onto its own flights, so the only contention is the shared catalog lock and
+ * the lock stripes that happen to collide. Persistence goes through the journal
+ * and the background flusher without fsync. Writes into ./data, so run it from
+ * a scratch directory:
+ *
+ *   g++ -std=c++17 -O2 -pthread -o reservation_scaling bench/reservation_scaling.cpp \
+ *       main/AirlineSystem.cpp main/FileManager.cpp main/Passenger.cpp main/Flight.cpp \
+ *       main/Reservation.cpp main/CsvReader.cpp main/CsvWriter.cpp main/MappedFile.cpp \
+ *       main/ThreadPool.cpp main/TrigramIndex.cpp main/InputValidator.cpp main/IdAllocator.cpp \
+ *       main/ReservationColumns.cpp main/FilterKernels.cpp main/LocalTime.cpp
+ *   mkdir -p /tmp/bench && cd /tmp/bench && /path/to/reservation_scaling [max_threads] [bookings]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../main/AirlineSystem.h"
+
+int main(int argc, char* argv[]) {
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    int max_threads = argc > 1 ? std::atoi(argv[1]) : static_cast<int>(hardware);
+    int bookings = argc > 2 ? std::atoi(argv[2]) : 200000;
+    const int flights_per_thread = 16;
+    time_t departure = std::time(nullptr) + 30 * 24 * 60 * 60;
+
+    std::cout << "Booking " << bookings << " reservations (" << hardware << " hardware threads)\n";
+    double single = 0;
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        std::filesystem::remove_all("data");
+        AirlineSystem system;
+        system.setDurability(Durability::None);
+        system.setJournaling(true, 100000);
+        system.setBackgroundFlush(true);
+
+        int per_thread = bookings / threads;
+        int seats = per_thread / flights_per_thread + 1;
+        std::vector<int> passengers;
+        std::vector<std::vector<int>> flights(threads);
+        for (int t = 0; t < threads; ++t) {
+            std::string digits = std::to_string(1000000000 + t);
+            passengers.push_back(system.addPassenger(Passenger("Bench Doe", "BN" + digits.substr(3), digits, "IRN")));
+            system.updateWalletBalance(passengers.back(), 1e12);
+            for (int f = 0; f < flights_per_thread; ++f) {
+                flights[t].push_back(system.addFlight(Flight("BN" + std::to_string(f), "Tehran", "Tabriz",
+                                                             departure, seats, 10.0)));
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                for (int i = 0; i < per_thread; ++i) {
+                    system.makeReservation(passengers[t], flights[t][i % flights_per_thread]);
+                }
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double rate = per_thread * threads / seconds;
+        if (threads == 1) single = rate;
+        std::cout << std::setw(3) << threads << " threads"
+                  << std::setw(14) << std::fixed << std::setprecision(0) << rate << " reservations/s"
+                  << std::setw(8) << std::setprecision(2) << rate / single << "x\n";
+    }
+    return 0;
+}
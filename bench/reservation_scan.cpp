@@ -0,0 +1,81 @@
+/*
+ * Filter scan over N reservations: the row store (std::deque<Reservation>, as
+ * AirlineSystem keeps it) against ReservationColumns::select. No files involved:
+ *
+ *   g++ -std=c++17 -O2 -o reservation_scan bench/reservation_scan.cpp \
+ *       main/Reservation.cpp main/ReservationColumns.cpp main/FilterKernels.cpp \
+ *       main/CsvReader.cpp main/CsvWriter.cpp
+ *   ./reservation_scan [reservations]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "../main/Reservation.h"
+#include "../main/ReservationColumns.h"
+#include "../main/FilterKernels.h"
+
+namespace {
+
+template <typename F>
+double secondsFor(F run, int repeats) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeats; ++i) run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / repeats;
+}
+
+void report(const char* name, size_t rows, size_t matched, double seconds) {
+    std::cout << std::left << std::setw(10) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(2) << seconds * 1000 << " ms"
+              << std::setw(14) << std::setprecision(0) << rows / seconds / 1e6 << " M rows/s"
+              << std::setw(10) << matched << " matched\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000000;
+    time_t now = std::time(nullptr);
+
+    std::deque<Reservation> reservations;
+    ReservationColumns columns;
+    columns.reserve(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        time_t departure = now + static_cast<time_t>(i % 1000) * 3600 - 500 * 3600;
+        reservations.push_back(Reservation::restore(static_cast<int>(i + 1), static_cast<int>(i % 5000) + 1,
+                                                    static_cast<int>(i % 800) + 1, 100.0 + i % 50,
+                                                    now, departure, i % 7 == 0, i % 97 == 0));
+        columns.append(reservations.back(), departure);
+    }
+
+    // Refunded bookings of completed flights, as generateReservationsReport filters them
+    ReservationFilter filter;
+    filter.now = now;
+    filter.completed_only = true;
+    filter.cancelled_only = true;
+
+    std::vector<size_t> by_row;
+    double row_seconds = secondsFor([&]() {
+        by_row.clear();
+        for (size_t i = 0; i < reservations.size(); ++i) {
+            const Reservation& r = reservations[i];
+            if (r.isDeleted()) continue;
+            if (r.getFlightDepartureTime() >= now) continue;
+            if (!r.isCancelled()) continue;
+            by_row.push_back(i);
+        }
+    }, 5);
+    std::vector<size_t> by_column;
+    double column_seconds = secondsFor([&]() { by_column = columns.select(filter); }, 5);
+
+    std::cout << "Scanning " << rows << " reservations ("
+              << (FilterKernels::usesAvx2() ? "AVX2" : "scalar") << " kernels)\n";
+    report("rows", rows, by_row.size(), row_seconds);
+    report("columns", rows, by_column.size(), column_seconds);
+    std::cout << "speedup   " << std::setprecision(1) << row_seconds / column_seconds << "x\n";
+    return by_row == by_column ? 0 : 1;
+}
@@ -0,0 +1,81 @@
+/*
+ * Save throughput: the old per-row stringstream + std::endl writer against
+ * FileManager's buffered block writer. Writes into ./data, so run it from a
+ * scratch directory:
+ *
+ *   g++ -std=c++17 -O2 -pthread -o save_benchmark bench/save_benchmark.cpp \
+ *       main/FileManager.cpp main/Passenger.cpp main/Flight.cpp main/Reservation.cpp \
+ *       main/CsvReader.cpp main/CsvWriter.cpp main/MappedFile.cpp main/ThreadPool.cpp
+ *   mkdir -p /tmp/bench && cd /tmp/bench && /path/to/save_benchmark [rows]
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include "../main/FileManager.h"
+
+namespace {
+
+// What Reservation::toCSV looked like before appendCSV existed
+std::string legacyCSV(const Reservation& r) {
+    std::stringstream ss;
+    ss << r.getReservationId() << ","
+       << r.getPassengerId() << ","
+       << r.getFlightId() << ","
+       << r.getAmountPaid() << ","
+       << r.getReservationTime() << ","
+       << r.getFlightDepartureTime() << ","
+       << (r.isCancelled() ? "1" : "0") << ","
+       << (r.isDeleted() ? "1" : "0");
+    return ss.str();
+}
+
+void legacySave(const std::deque<Reservation>& reservations) {
+    std::ofstream file("data/reservations.csv", std::ios::trunc);
+    for (const auto& reservation : reservations) {
+        file << legacyCSV(reservation) << std::endl;
+    }
+}
+
+template <typename F>
+double secondsFor(F run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, size_t rows, double seconds) {
+    std::cout << std::left << std::setw(10) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(3) << seconds << " s"
+              << std::setw(14) << std::setprecision(0) << rows / seconds << " rows/s\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::filesystem::create_directories("data");
+
+    std::deque<Reservation> reservations;
+    for (size_t i = 1; i <= rows; ++i) {
+        reservations.push_back(Reservation::restore(static_cast<int>(i), static_cast<int>(i % 5000) + 1,
+                                                    static_cast<int>(i % 300) + 1, 125.5 + i % 7,
+                                                    1700000000 + i, 1766249400, i % 11 == 0, false));
+    }
+
+    FileManager manager;
+    double legacy = secondsFor([&]() { legacySave(reservations); });
+    double buffered = secondsFor([&]() { manager.saveReservations(reservations); });
+
+    std::cout << "Saving " << rows << " reservations\n";
+    report("legacy", rows, legacy);
+    report("buffered", rows, buffered);
+    std::cout << "speedup   " << std::setprecision(1) << legacy / buffered << "x\n";
+    return 0;
+}
@@ -0,0 +1,63 @@
+// Per-row date formatting: localtime_r + strftime against LocalTime::formatDate,
+// single-threaded over N departure times an hour apart. No files involved:
+//
+//   g++ -std=c++17 -O2 -o time_format bench/time_format.cpp main/LocalTime.cpp
+//   ./time_format [rows]
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include "../main/LocalTime.h"
+
+namespace {
+
+template <typename F>
+double secondsFor(F run) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void report(const char* name, size_t rows, double seconds) {
+    std::cout << std::left << std::setw(12) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(1) << seconds * 1e9 / rows
+              << " ns/row\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    size_t rows = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000000;
+    time_t base = std::time(nullptr);
+    unsigned checksum = 0;
+
+    double libc = secondsFor([&]() {
+        for (size_t i = 0; i < rows; ++i) {
+            time_t t = base + static_cast<time_t>(i % 20000) * 3600;
+            tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &t);
+#else
+            localtime_r(&t, &local);
+#endif
+            char date_str[11];
+            std::strftime(date_str, sizeof(date_str), "%Y-%m-%d", &local);
+            checksum += static_cast<unsigned char>(date_str[9]);
+        }
+    });
+    double cached = secondsFor([&]() {
+        for (size_t i = 0; i < rows; ++i) {
+            char date_str[11];
+            LocalTime::formatDate(base + static_cast<time_t>(i % 20000) * 3600, date_str);
+            checksum -= static_cast<unsigned char>(date_str[9]);
+        }
+    });
+
+    std::cout << "Formatting " << rows << " dates\n";
+    report("strftime", rows, libc);
+    report("LocalTime", rows, cached);
+    std::cout << "speedup     " << std::setprecision(1) << libc / cached << "x\n";
+    return checksum == 0 ? 0 : 1;
+}
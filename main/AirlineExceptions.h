@@ -49,3 +49,20 @@ class RefundNotAllowedException : public AirlineException {
 public:
     RefundNotAllowedException() : AirlineException("Refund is not allowed due to time constraints") {}
 };
+
+class CsvParseException : public AirlineException {
+private:
+    size_t row;
+    size_t column;
+    std::string reason;
+
+public:
+    CsvParseException(size_t row, size_t column, const std::string& reason)
+        : AirlineException("CSV parse error at row " + std::to_string(row) +
+                           ", column " + std::to_string(column) + ": " + reason),
+          row(row), column(column), reason(reason) {}
+
+    size_t getRow() const { return row; }
+    size_t getColumn() const { return column; }
+    const std::string& getReason() const { return reason; }
+};
\ No newline at end of file
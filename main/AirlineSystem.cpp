@@ -1,4 +1,8 @@
 #include "AirlineSystem.h"
+#include "InputValidator.h"
+#include "CsvReader.h"
+#include "OrderedOutput.h"
+#include "LocalTime.h"
 #include <algorithm>
 #include <stdexcept>
 #include <sstream>
@@ -6,37 +10,398 @@
 #include <iomanip>
 #include <fstream>  // Add this
 #include <ctime>    // Add this
+#include <limits>
+#include <unordered_set>
 
-AirlineSystem::AirlineSystem() {
+namespace {
+
+// Keeps the first live row for an id; a tombstoned row only wins if nothing else is indexed.
+template <typename T>
+void indexSlot(std::unordered_map<int, size_t>& slots, const std::deque<T>& rows, int id, size_t slot) {
+    auto result = slots.emplace(id, slot);
+    if (!result.second && rows[result.first->second].isDeleted() && !rows[slot].isDeleted()) {
+        result.first->second = slot;
+    }
+}
+
+const std::vector<size_t>& adjacentSlots(const std::unordered_map<int, std::vector<size_t>>& lists, int id) {
+    static const std::vector<size_t> none;
+    auto it = lists.find(id);
+    return it != lists.end() ? it->second : none;
+}
+
+// Report layouts shared by the single reports and generateReports
+const char* const RESERVATIONS_REPORT_HEADER = "Reservation ID,Passenger Name,Flight Number,Date,Status,Amount\n";
+const char* const FUTURE_FLIGHTS_REPORT_HEADER = "Flight Number,Origin,Destination,Date,Time,Available Seats,Price\n";
+const char* const FLIGHT_PASSENGERS_REPORT_HEADER = "Passenger ID,Name,Passport,Nationality,Status\n";
+
+void writeReservationRow(std::ostream& out, const Reservation& res, const Passenger& passenger,
+                         const Flight& flight, bool completed) {
+    char date_str[11];
+    LocalTime::formatDate(flight.getDepartureTime(), date_str);
+
+    out << res.getReservationId() << ","
+        << passenger.getName() << ","
+        << flight.getFlightNumber() << ","
+        << date_str << ","
+        << (res.isCancelled() ? "Refunded" : (completed ? "Completed" : "Future")) << ","
+        << res.getAmountPaid() << "\n";
+}
+
+void writeFutureFlightRow(std::ostream& out, const Flight& flight) {
+    char date_str[11], time_str[9];
+    LocalTime::formatDate(flight.getDepartureTime(), date_str);
+    LocalTime::formatTime(flight.getDepartureTime(), time_str);
+
+    out << flight.getFlightNumber() << ","
+        << flight.getOrigin() << ","
+        << flight.getDestination() << ","
+        << date_str << ","
+        << time_str << ","
+        << flight.getAvailableSeats() << ","
+        << flight.getTicketPrice() << "\n";
+}
+
+void writeFlightPassengerRow(std::ostream& out, const Passenger& passenger, const Reservation& res) {
+    out << passenger.getPassengerId() << ","
+        << passenger.getName() << ","
+        << passenger.getPassportNumber() << ","
+        << passenger.getNationality() << ","
+        << (res.isCancelled() ? "Cancelled" : "Confirmed") << "\n";
+}
+
+void eraseSlot(std::multimap<time_t, size_t>& schedule, time_t departure, size_t slot) {
+    auto range = schedule.equal_range(departure);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == slot) {
+            schedule.erase(it);
+            return;
+        }
+    }
+}
+
+template <typename T>
+T* lookupSlot(const std::unordered_map<int, size_t>& slots, std::deque<T>& rows, int id) {
+    auto it = slots.find(id);
+    if (it == slots.end()) return nullptr;
+    T& row = rows[it->second];
+    return row.isDeleted() ? nullptr : &row;
+}
+
+template <typename T>
+void dropDuplicates(std::vector<T*>& rows) {
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+}
+
+}
+
+AirlineSystem::AirlineSystem(SnapshotFormat format) {
+    file_manager.setSnapshotFormat(format);
+    file_manager.setThreadPool(&workers);
     loadAllData();
     ensureFileExists();
 }
 
 AirlineSystem::~AirlineSystem() {
+    stopFlusher();
     saveAllData();
 }
 
 void AirlineSystem::loadAllData() {
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> changes(changes_mutex);
+    std::lock_guard<std::mutex> io(persist_mutex);
     try {
-        passengers = file_manager.loadPassengers();
-        flights = file_manager.loadFlights();
-        reservations = file_manager.loadReservations();
+        file_manager.recoverCommit();
+        bool binary = file_manager.getSnapshotFormat() == SnapshotFormat::Binary;
+        IdSequences stored;
+        if (binary && file_manager.hasBinarySnapshot()) {
+            stored = file_manager.loadBinarySnapshot(passengers, flights, reservations);
+        } else {
+            file_manager.loadTables(passengers, flights, reservations);
+            stored = file_manager.loadSequences();
+        }
+        passenger_ids.observe(stored.passenger - 1);
+        flight_ids.observe(stored.flight - 1);
+        reservation_ids.observe(stored.reservation - 1);
+        last_reservation_id = stored.reservation - 1;
+        passenger_table.markSaved(passengers.size());
+        flight_table.markSaved(flights.size());
+        reservation_table.markSaved(reservations.size());
+        if (binary && !file_manager.hasBinarySnapshot()) {
+            // First start in binary mode: the next save converts the CSV data
+            passenger_table.markAll();
+        }
+
+        journal_records = file_manager.replayJournal(passengers, flights, reservations);
+        if (journal_records > 0) {
+            // Replayed rows may overwrite any slot, so the next snapshot rewrites everything
+            passenger_table.markAll();
+            flight_table.markAll();
+            reservation_table.markAll();
+        }
     } catch (const std::exception& e) {
         throw std::runtime_error("Failed to load data: " + std::string(e.what()));
     }
+    rebuildIndexes();
+    inferFlightCapacities();
+    // Tombstones loaded from disk count toward the threshold; the first compaction
+    // learns how many of them have to stay
+    dead_rows_kept = 0;
+}
+
+void AirlineSystem::inferFlightCapacities() {
+    // Flights saved before capacity was stored: every free seat plus every seat still booked
+    for (auto& flight : flights) {
+        if (flight.hasCapacity()) continue;
+        const auto& slots = reservationSlotsOfFlight(flight.getFlightId());
+        int booked = static_cast<int>(std::count_if(slots.begin(), slots.end(), [this](size_t slot) {
+            const Reservation& r = reservations[slot];
+            return !r.isCancelled() && !r.isDeleted();
+        }));
+        flight.setCapacity(flight.getAvailableSeats() + booked);
+    }
+}
+
+void AirlineSystem::rebuildIndexes() {
+    dead_rows = 0;
+    passenger_slots.clear();
+    passenger_slots.reserve(passengers.size());
+    national_id_index.clear();
+    passport_index.clear();
+    passenger_text_index.clear();
+    for (size_t i = 0; i < passengers.size(); ++i) {
+        indexSlot(passenger_slots, passengers, passengers[i].getPassengerId(), i);
+        passenger_ids.observe(passengers[i].getPassengerId());
+        indexPassenger(passengers[i], i);
+        if (passengers[i].isDeleted()) ++dead_rows;
+    }
+
+    flight_slots.clear();
+    flight_slots.reserve(flights.size());
+    flights_by_departure.clear();
+    flights_by_route.clear();
+    for (size_t i = 0; i < flights.size(); ++i) {
+        indexSlot(flight_slots, flights, flights[i].getFlightId(), i);
+        flight_ids.observe(flights[i].getFlightId());
+        if (!flights[i].isDeleted()) {
+            indexFlightSchedule(flights[i], i);
+        } else {
+            ++dead_rows;
+        }
+    }
+
+    reservation_slots.clear();
+    reservation_slots.reserve(reservations.size());
+    passenger_reservations.clear();
+    flight_reservations.clear();
+    reservation_columns.clear();
+    reservation_columns.reserve(reservations.size());
+    for (size_t i = 0; i < reservations.size(); ++i) {
+        indexSlot(reservation_slots, reservations, reservations[i].getReservationId(), i);
+        reservation_ids.observe(reservations[i].getReservationId());
+        last_reservation_id = std::max(last_reservation_id, reservations[i].getReservationId());
+        indexReservationLinks(reservations[i], i);
+        indexReservationColumns(reservations[i]);
+        if (reservations[i].isDeleted()) ++dead_rows;
+    }
+}
+
+size_t AirlineSystem::compact() {
+    size_t removed;
+    {
+        std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+        std::lock_guard<std::mutex> changes(changes_mutex);
+        removed = compactUnlocked();
+        if (removed > 0) persistAll();
+    }
+    return removed;
+}
+
+size_t AirlineSystem::compactUnlocked() {
+    size_t before = passengers.size() + flights.size() + reservations.size();
+
+    // Reservations go first, so a deleted reservation no longer keeps its passenger or flight
+    reservations.erase(std::remove_if(reservations.begin(), reservations.end(),
+                                      [](const Reservation& r) { return r.isDeleted(); }),
+                       reservations.end());
+    std::unordered_set<int> booked_passengers;
+    std::unordered_set<int> booked_flights;
+    for (const auto& reservation : reservations) {
+        booked_passengers.insert(reservation.getPassengerId());
+        booked_flights.insert(reservation.getFlightId());
+    }
+    passengers.erase(std::remove_if(passengers.begin(), passengers.end(),
+                                    [&](const Passenger& p) {
+                                        return p.isDeleted() && !booked_passengers.count(p.getPassengerId());
+                                    }),
+                     passengers.end());
+    flights.erase(std::remove_if(flights.begin(), flights.end(),
+                                 [&](const Flight& f) {
+                                     return f.isDeleted() && !booked_flights.count(f.getFlightId());
+                                 }),
+                  flights.end());
+
+    size_t removed = before - (passengers.size() + flights.size() + reservations.size());
+    if (removed > 0) {
+        // Every slot after the first removed row moved, so indexes and files are rebuilt whole
+        rebuildIndexes();
+        passenger_table.markAll();
+        flight_table.markAll();
+        reservation_table.markAll();
+    }
+    dead_rows_kept = dead_rows;
+    return removed;
+}
+
+void AirlineSystem::compactIfDue() {
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+    if (!auto_compact || dead_rows - dead_rows_kept < compact_min_rows) return;
+    size_t total = passengers.size() + flights.size() + reservations.size();
+    if (static_cast<double>(dead_rows) < compact_dead_ratio * static_cast<double>(total)) return;
+
+    std::lock_guard<std::mutex> changes(changes_mutex);
+    if (compactUnlocked() > 0) persistAll();
+}
+
+void AirlineSystem::setAutoCompact(bool enabled, double dead_ratio, size_t min_rows) {
+    {
+        std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+        auto_compact = enabled;
+        compact_dead_ratio = dead_ratio;
+        compact_min_rows = std::max<size_t>(min_rows, 1);
+    }
+    // Data loaded with enough tombstones is compacted right away, not at the next delete
+    compactIfDue();
+}
+
+StorageStats AirlineSystem::storageStats() const {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> guard(reservations_mutex);
+    auto count = [](const auto& rows) {
+        TableStats stats;
+        for (const auto& row : rows) {
+            ++(row.isDeleted() ? stats.dead : stats.live);
+        }
+        return stats;
+    };
+    StorageStats stats;
+    stats.passengers = count(passengers);
+    stats.flights = count(flights);
+    stats.reservations = count(reservations);
+    return stats;
+}
+
+IdSequences AirlineSystem::sequences() const {
+    IdSequences next;
+    next.passenger = passenger_ids.peek();
+    next.flight = flight_ids.peek();
+    next.reservation = last_reservation_id + 1;
+    return next;
+}
+
+void AirlineSystem::indexReservationLinks(const Reservation& reservation, size_t slot) {
+    passenger_reservations[reservation.getPassengerId()].push_back(slot);
+    flight_reservations[reservation.getFlightId()].push_back(slot);
+}
+
+void AirlineSystem::indexReservationColumns(const Reservation& reservation) {
+    // Reports judge a booking by its flight's departure, which the row may predate
+    auto flight = flight_slots.find(reservation.getFlightId());
+    time_t departure = flight != flight_slots.end() ? flights[flight->second].getDepartureTime()
+                                                    : reservation.getFlightDepartureTime();
+    reservation_columns.append(reservation, departure);
+}
+
+const std::vector<size_t>& AirlineSystem::reservationSlotsOfPassenger(int passenger_id) const {
+    return adjacentSlots(passenger_reservations, passenger_id);
+}
+
+const std::vector<size_t>& AirlineSystem::reservationSlotsOfFlight(int flight_id) const {
+    return adjacentSlots(flight_reservations, flight_id);
+}
+
+void AirlineSystem::indexFlightSchedule(const Flight& flight, size_t slot) {
+    flights_by_departure.emplace(flight.getDepartureTime(), slot);
+    flights_by_route[{flight.getOrigin(), flight.getDestination()}].emplace(flight.getDepartureTime(), slot);
+}
+
+void AirlineSystem::unindexFlightSchedule(const Flight& flight, size_t slot) {
+    eraseSlot(flights_by_departure, flight.getDepartureTime(), slot);
+
+    auto route = flights_by_route.find({flight.getOrigin(), flight.getDestination()});
+    if (route != flights_by_route.end()) {
+        eraseSlot(route->second, flight.getDepartureTime(), slot);
+        if (route->second.empty()) flights_by_route.erase(route);
+    }
 }
 
 void AirlineSystem::saveAllData() {
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> changes(changes_mutex);
+    persistAll();
+}
+
+void AirlineSystem::persistAll() {
+    std::lock_guard<std::mutex> io(persist_mutex);
     try {
-        file_manager.savePassengers(passengers);
-        file_manager.saveFlights(flights);
-        file_manager.saveReservations(reservations);
+        if (file_manager.getSnapshotFormat() == SnapshotFormat::Binary) {
+            saveBinaryTables();
+        } else {
+            saveCsvTables();
+        }
+        // The snapshot now holds everything the journal did
+        file_manager.clearJournal();
+        journal_records = 0;
+        pending_journal.clear();
     } catch (const std::exception& e) {
         throw std::runtime_error("Failed to save data: " + std::string(e.what()));
     }
 }
 
+void AirlineSystem::saveCsvTables() {
+    // Untouched tables keep their files; tables that only grew get their new rows appended.
+    // The dirty tables are staged and then replace the live files as one group.
+    bool passengers_dirty = passenger_table.isDirty();
+    bool flights_dirty = flight_table.isDirty();
+    bool reservations_dirty = reservation_table.isDirty();
+    file_manager.beginCommit();
+    try {
+        if (passengers_dirty) {
+            file_manager.savePassengers(passengers, passenger_table.isAppendOnly() ? passenger_table.persisted_rows : 0);
+        }
+        if (flights_dirty) {
+            file_manager.saveFlights(flights, flight_table.isAppendOnly() ? flight_table.persisted_rows : 0);
+        }
+        if (reservations_dirty) {
+            file_manager.saveReservations(reservations, reservation_table.isAppendOnly() ? reservation_table.persisted_rows : 0);
+        }
+        if (passengers_dirty || flights_dirty || reservations_dirty) {
+            file_manager.saveSequences(sequences());
+        }
+        file_manager.commitTables();
+    } catch (...) {
+        file_manager.abortCommit();
+        throw;
+    }
+    if (passengers_dirty) passenger_table.markSaved(passengers.size());
+    if (flights_dirty) flight_table.markSaved(flights.size());
+    if (reservations_dirty) reservation_table.markSaved(reservations.size());
+}
+
+void AirlineSystem::saveBinaryTables() {
+    // The binary snapshot is a single file, so any change rewrites all of it
+    if (!hasDirtyTables()) return;
+    file_manager.saveBinarySnapshot(passengers, flights, reservations, sequences());
+    passenger_table.markSaved(passengers.size());
+    flight_table.markSaved(flights.size());
+    reservation_table.markSaved(reservations.size());
+}
+
 void AirlineSystem::ensureFileExists() {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> io(persist_mutex);
     try {
         if (passengers.empty()) {
             file_manager.savePassengers(passengers);
@@ -52,94 +417,538 @@ void AirlineSystem::ensureFileExists() {
     }
 }
 
+bool AirlineSystem::hasDirtyTables() const {
+    return passenger_table.isDirty() || flight_table.isDirty() || reservation_table.isDirty();
+}
+
+void AirlineSystem::markChanged(const Passenger& passenger) {
+    std::lock_guard<std::mutex> changes(changes_mutex);
+    markChangedUnlocked(passenger);
+}
+
+void AirlineSystem::markChangedUnlocked(const Passenger& passenger) {
+    passenger_table.markRow(passenger_slots.at(passenger.getPassengerId()));
+    if (journaling) {
+        pending_journal += "P,";
+        passenger.appendCSV(pending_journal);
+        pending_journal += '\n';
+    }
+}
+
+void AirlineSystem::markChanged(const Flight& flight) {
+    std::lock_guard<std::mutex> changes(changes_mutex);
+    markChangedUnlocked(flight);
+}
+
+void AirlineSystem::markChangedUnlocked(const Flight& flight) {
+    flight_table.markRow(flight_slots.at(flight.getFlightId()));
+    if (journaling) {
+        pending_journal += "F,";
+        flight.appendCSV(pending_journal);
+        pending_journal += '\n';
+    }
+}
+
+void AirlineSystem::markChanged(const Reservation& reservation) {
+    std::lock_guard<std::mutex> changes(changes_mutex);
+    markChangedUnlocked(reservation);
+}
+
+void AirlineSystem::markChangedUnlocked(const Reservation& reservation) {
+    reservation_table.markRow(reservation_slots.at(reservation.getReservationId()));
+    if (journaling) {
+        pending_journal += "R,";
+        reservation.appendCSV(pending_journal);
+        pending_journal += '\n';
+    }
+}
+
 void AirlineSystem::autoSave() {
-    if (data_changed) {
+    if (background_flush) {
+        bool due;
+        {
+            std::lock_guard<std::mutex> lock(flush_mutex);
+            due = ++pending_operations >= flush_operations;
+        }
+        if (due) {
+            flush_wakeup.notify_one();
+        }
+        return;
+    }
+
+    // Runs after the mutation released its locks, so it may pick up other threads' changes too
+    try {
+        std::unique_lock<std::mutex> changes(changes_mutex);
+        if (!journaling) {
+            bool dirty = hasDirtyTables();
+            changes.unlock();
+            if (dirty) {
+                saveAllData();
+            }
+            return;
+        }
+        if (pending_journal.empty()) {
+            return;
+        }
+
+        std::string record = pending_journal + "C\n";
+        pending_journal.clear();
+        bool checkpoint_due = ++journal_records >= checkpoint_interval;
+        {
+            // Taken before changes_mutex is released so records reach the journal in order
+            std::lock_guard<std::mutex> io(persist_mutex);
+            changes.unlock();
+            file_manager.appendJournal(record);
+        }
+        if (checkpoint_due) {
+            checkpoint();
+        }
+    } catch (const std::exception& e) {
+        // Log error but don't throw to prevent disrupting normal operation
+        std::cerr << "Auto-save failed: " << e.what() << std::endl;
+    }
+}
+
+void AirlineSystem::checkpoint() {
+    saveAllData();
+}
+
+void AirlineSystem::setJournaling(bool enabled, size_t checkpoint_interval) {
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> changes(changes_mutex);
+    if (journaling && !enabled) {
+        // Fold the journal back into the snapshot before going back to full rewrites
+        persistAll();
+    }
+    journaling = enabled;
+    this->checkpoint_interval = checkpoint_interval > 0 ? checkpoint_interval : 1;
+}
+
+bool AirlineSystem::isJournaling() const {
+    std::lock_guard<std::mutex> changes(changes_mutex);
+    return journaling;
+}
+
+void AirlineSystem::setDurability(Durability level) {
+    std::lock_guard<std::mutex> io(persist_mutex);
+    file_manager.setDurability(level);
+}
+
+bool AirlineSystem::hasUnsavedChanges() const {
+    std::lock_guard<std::mutex> changes(changes_mutex);
+    return !pending_journal.empty() || (!journaling && hasDirtyTables());
+}
+
+void AirlineSystem::setBackgroundFlush(bool enabled, std::chrono::milliseconds interval, size_t max_operations) {
+    background_flush = false;
+    stopFlusher();
+    // Whatever the old flusher had not picked up yet
+    flushPending();
+    if (!enabled) {
+        return;
+    }
+
+    flush_interval = interval;
+    flush_operations = max_operations > 0 ? max_operations : 1;
+    pending_operations = 0;
+    flusher_running = true;
+    flusher = std::thread(&AirlineSystem::runFlusher, this);
+    background_flush = true;
+}
+
+void AirlineSystem::stopFlusher() {
+    {
+        std::lock_guard<std::mutex> lock(flush_mutex);
+        flusher_running = false;
+    }
+    flush_wakeup.notify_one();
+    if (flusher.joinable()) {
+        flusher.join();
+    }
+}
+
+void AirlineSystem::runFlusher() {
+    std::unique_lock<std::mutex> lock(flush_mutex);
+    while (flusher_running) {
+        flush_wakeup.wait_for(lock, flush_interval, [this]() {
+            return !flusher_running || pending_operations >= flush_operations;
+        });
+        if (!flusher_running || pending_operations == 0) {
+            continue;   // whoever stops the flusher writes what is left
+        }
+        pending_operations = 0;
+        lock.unlock();
+        flushPending();
+        lock.lock();
+    }
+}
+
+void AirlineSystem::flushPending() {
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::unique_lock<std::mutex> changes(changes_mutex);
+    PendingFlush batch = captureFlush();
+    // Taking persist_mutex before letting go of the tables keeps batches on disk in capture order
+    std::unique_lock<std::mutex> io(persist_mutex);
+    changes.unlock();
+    catalog.unlock();
+    try {
+        writeFlush(batch);
+        return;
+    } catch (const std::exception& e) {
+        std::cerr << "Background save failed: " << e.what() << std::endl;
+    }
+    io.unlock();
+    changes.lock();
+    restoreFlush(batch);
+}
+
+AirlineSystem::PendingFlush AirlineSystem::captureFlush() {
+    PendingFlush batch;
+    if (journaling) {
+        if (pending_journal.empty()) {
+            return batch;
+        }
+        if (journal_records + 1 < checkpoint_interval) {
+            // All mutations since the last flush become one journal record
+            batch.journal = pending_journal + "C\n";
+            pending_journal.clear();
+            ++journal_records;
+            return batch;
+        }
+    } else if (!hasDirtyTables()) {
+        return batch;
+    }
+
+    batch.snapshot = true;
+    if (file_manager.getSnapshotFormat() == SnapshotFormat::Binary) {
+        batch.binary_image = file_manager.binarySnapshotImage(passengers, flights, reservations, sequences());
+        passenger_table.markSaved(passengers.size());
+        flight_table.markSaved(flights.size());
+        reservation_table.markSaved(reservations.size());
+    } else {
+        if (passenger_table.isDirty()) {
+            batch.tables.push_back(file_manager.passengersImage(
+                passengers, passenger_table.isAppendOnly() ? passenger_table.persisted_rows : 0));
+            passenger_table.markSaved(passengers.size());
+        }
+        if (flight_table.isDirty()) {
+            batch.tables.push_back(file_manager.flightsImage(
+                flights, flight_table.isAppendOnly() ? flight_table.persisted_rows : 0));
+            flight_table.markSaved(flights.size());
+        }
+        if (reservation_table.isDirty()) {
+            batch.tables.push_back(file_manager.reservationsImage(
+                reservations, reservation_table.isAppendOnly() ? reservation_table.persisted_rows : 0));
+            reservation_table.markSaved(reservations.size());
+        }
+        batch.tables.push_back(file_manager.sequencesImage(sequences()));
+    }
+    batch.folded_journal.swap(pending_journal);
+    batch.folded_records = journal_records;
+    journal_records = 0;
+    return batch;
+}
+
+void AirlineSystem::writeFlush(const PendingFlush& batch) {
+    if (!batch.journal.empty()) {
+        file_manager.appendJournal(batch.journal);
+    }
+    if (!batch.snapshot) {
+        return;
+    }
+
+    if (file_manager.getSnapshotFormat() == SnapshotFormat::Binary) {
+        file_manager.saveBinaryImage(batch.binary_image);
+    } else {
+        file_manager.beginCommit();
         try {
-            saveAllData();
-            data_changed = false;
-        } catch (const std::exception& e) {
-            // Log error but don't throw to prevent disrupting normal operation
-            std::cerr << "Auto-save failed: " << e.what() << std::endl;
+            for (const auto& table : batch.tables) {
+                file_manager.saveTableImage(table);
+            }
+            file_manager.commitTables();
+        } catch (...) {
+            file_manager.abortCommit();
+            throw;
         }
     }
+    file_manager.clearJournal();
+}
+
+void AirlineSystem::restoreFlush(const PendingFlush& batch) {
+    // Hand the lost work back so the next flush retries it
+    if (!batch.journal.empty()) {
+        pending_journal.insert(0, batch.journal, 0, batch.journal.size() - 2);
+        --journal_records;
+    }
+    if (batch.snapshot) {
+        passenger_table.markAll();
+        flight_table.markAll();
+        reservation_table.markAll();
+        // Without its journal lines a journaling flush would see nothing to retry
+        pending_journal.insert(0, batch.folded_journal);
+        journal_records += batch.folded_records;
+    }
 }
 
 bool AirlineSystem::isNationalIdTaken(const std::string& national_id, int exclude_id) {
-    return std::find_if(passengers.begin(), passengers.end(),
-        [&](const Passenger& p) {
-            return !p.isDeleted() && p.getNationalId() == national_id && 
-                   p.getPassengerId() != exclude_id;
-        }) != passengers.end();
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    return isNationalIdTakenUnlocked(national_id, exclude_id);
 }
 
 bool AirlineSystem::isPassportNumberTaken(const std::string& passport, int exclude_id) {
-    return std::find_if(passengers.begin(), passengers.end(),
-        [&](const Passenger& p) {
-            return !p.isDeleted() && p.getPassportNumber() == passport && 
-                   p.getPassengerId() != exclude_id;
-        }) != passengers.end();
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    return isPassportNumberTakenUnlocked(passport, exclude_id);
+}
+
+bool AirlineSystem::isNationalIdTakenUnlocked(const std::string& national_id, int exclude_id) const {
+    auto it = national_id_index.find(national_id);
+    return it != national_id_index.end() && it->second != exclude_id;
+}
+
+bool AirlineSystem::isPassportNumberTakenUnlocked(const std::string& passport, int exclude_id) const {
+    auto it = passport_index.find(passport);
+    return it != passport_index.end() && it->second != exclude_id;
+}
+
+void AirlineSystem::indexPassenger(const Passenger& passenger, size_t slot) {
+    if (passenger.isDeleted()) return;
+    national_id_index.emplace(passenger.getNationalId(), passenger.getPassengerId());
+    passport_index.emplace(passenger.getPassportNumber(), passenger.getPassengerId());
+    passenger_text_index.add(slot, {passenger.getName(), passenger.getPassportNumber(), passenger.getNationalId()});
+}
+
+void AirlineSystem::unindexPassenger(const Passenger& passenger, size_t slot) {
+    passenger_text_index.remove(slot, {passenger.getName(), passenger.getPassportNumber(), passenger.getNationalId()});
+
+    auto national_id = national_id_index.find(passenger.getNationalId());
+    if (national_id != national_id_index.end() && national_id->second == passenger.getPassengerId()) {
+        national_id_index.erase(national_id);
+    }
+    auto passport = passport_index.find(passenger.getPassportNumber());
+    if (passport != passport_index.end() && passport->second == passenger.getPassengerId()) {
+        passport_index.erase(passport);
+    }
 }
 
 int AirlineSystem::addPassenger(const Passenger& passenger) {
+    int passenger_id;
     try {
-        if (isNationalIdTaken(passenger.getNationalId())) {
-            throw AirlineException("National ID already exists");
-        }
-        if (isPassportNumberTaken(passenger.getPassportNumber())) {
-            throw AirlineException("Passport number already exists");
+        {
+            std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+            file_manager.validatePassengerData(passenger);
+            if (isNationalIdTakenUnlocked(passenger.getNationalId(), -1)) {
+                throw AirlineException("National ID already exists");
+            }
+            if (isPassportNumberTakenUnlocked(passenger.getPassportNumber(), -1)) {
+                throw AirlineException("Passport number already exists");
+            }
+
+            passenger_id = insertPassenger(passenger);
         }
-        
-        passengers.push_back(passenger);
-        markDataAsChanged();
         autoSave();
-        return passenger.getPassengerId();
+        return passenger_id;
     } catch (const std::exception& e) {
         throw AirlineException("Failed to add passenger: " + std::string(e.what()));
     }
 }
 
+int AirlineSystem::insertPassenger(const Passenger& passenger) {
+    passengers.push_back(passenger);
+    Passenger& added = passengers.back();
+    added.setPassengerId(passenger_ids.next());
+    indexSlot(passenger_slots, passengers, added.getPassengerId(), passengers.size() - 1);
+    indexPassenger(added, passengers.size() - 1);
+    markChanged(added);
+    return added.getPassengerId();
+}
+
+ImportReport AirlineSystem::importRows(const std::string& path, const std::function<void(const CsvRow&)>& insert_row) {
+    ImportReport report;
+    {
+        std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+        size_t current_row = 0;
+        try {
+            file_manager.forEachRow(path, [&report, &insert_row, &current_row](const CsvRow& row) {
+                current_row = row.row();
+                try {
+                    insert_row(row);
+                    ++report.imported;
+                } catch (const AirlineException& e) {
+                    report.rejected.push_back({row.row(), e.what()});
+                }
+            });
+        } catch (const std::exception& e) {
+            // A file that can't be opened fails before any row. A failure later on must not
+            // strand the rows already inserted, so it ends the import and they are saved.
+            if (current_row == 0) throw;
+            report.rejected.push_back({current_row, "Import stopped: " + std::string(e.what())});
+        }
+    }
+    autoSave();
+    return report;
+}
+
+ImportReport AirlineSystem::importPassengers(const std::string& path) {
+    return importRows(path, [this](const CsvRow& row) {
+        Passenger passenger(std::string(row.text(0)), std::string(row.text(1)),
+                            std::string(row.text(2)), std::string(row.text(3)));
+        if (!InputValidator::validatePassportNumber(passenger.getPassportNumber())) {
+            throw InvalidInputException("passport number");
+        }
+        if (!InputValidator::validateNationalId(passenger.getNationalId())) {
+            throw InvalidInputException("national ID");
+        }
+        file_manager.validatePassengerData(passenger);
+        // Earlier rows of the same file are already indexed, so duplicates within it are caught too
+        if (isNationalIdTakenUnlocked(passenger.getNationalId(), -1)) {
+            throw AirlineException("National ID already exists");
+        }
+        if (isPassportNumberTakenUnlocked(passenger.getPassportNumber(), -1)) {
+            throw AirlineException("Passport number already exists");
+        }
+        insertPassenger(passenger);
+    });
+}
+
 Passenger* AirlineSystem::findPassenger(int passenger_id) {
-    auto it = std::find_if(passengers.begin(), passengers.end(),
-        [passenger_id](const Passenger& p) { 
-            return p.getPassengerId() == passenger_id && !p.isDeleted(); 
-        });
-    return it != passengers.end() ? &(*it) : nullptr;
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    return findPassengerUnlocked(passenger_id);
+}
+
+Passenger* AirlineSystem::findPassengerUnlocked(int passenger_id) {
+    return lookupSlot(passenger_slots, passengers, passenger_id);
 }
 
 std::vector<Passenger> AirlineSystem::searchPassengers(const std::string& search_term) {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    // Wallets can change under a shared catalog lock, so copies are taken under the stripe
     std::vector<Passenger> results;
-    for (const auto& p : passengers) {
-        if (p.isDeleted()) continue;
-        
-        if (p.getName().find(search_term) != std::string::npos ||
-            p.getPassportNumber().find(search_term) != std::string::npos ||
-            p.getNationalId().find(search_term) != std::string::npos) {
-            results.push_back(p);
+    auto collect = [this, &results](const Passenger& p) {
+        std::lock_guard<std::mutex> stripe(passengerLock(p.getPassengerId()));
+        results.push_back(p);
+    };
+    auto matches = [&search_term](const Passenger& p) {
+        return !p.isDeleted() &&
+               (p.getName().find(search_term) != std::string::npos ||
+                p.getPassportNumber().find(search_term) != std::string::npos ||
+                p.getNationalId().find(search_term) != std::string::npos);
+    };
+
+    std::vector<size_t> candidates;
+    if (passenger_text_index.candidates(search_term, candidates)) {
+        for (size_t slot : candidates) {
+            if (matches(passengers[slot])) collect(passengers[slot]);
         }
+        return results;
+    }
+
+    // Terms too short to narrow by trigram fall back to a full scan
+    for (const auto& p : passengers) {
+        if (matches(p)) collect(p);
     }
     return results;
 }
 
+bool AirlineSystem::updateWalletBalance(int passenger_id, double amount) {
+    {
+        std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+        std::lock_guard<std::mutex> stripe(passengerLock(passenger_id));
+        auto passenger = findPassengerUnlocked(passenger_id);
+        if (!passenger) {
+            throw PassengerNotFoundException();
+        }
+
+        passenger->updateWalletBalance(amount);
+        markChanged(*passenger);
+    }
+    autoSave();
+    return true;
+}
+
 int AirlineSystem::addFlight(const Flight& flight) {
+    int flight_id;
     try {
-        flights.push_back(flight);
-        markDataAsChanged();
+        {
+            std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+            file_manager.validateFlightData(flight);
+            flight_id = insertFlight(flight);
+        }
         autoSave();
-        return flight.getFlightId();
+        return flight_id;
     } catch (const std::exception& e) {
         throw AirlineException("Failed to add flight: " + std::string(e.what()));
     }
 }
 
+int AirlineSystem::insertFlight(const Flight& flight) {
+    flights.push_back(flight);
+    Flight& added = flights.back();
+    added.setFlightId(flight_ids.next());
+    indexSlot(flight_slots, flights, added.getFlightId(), flights.size() - 1);
+    indexFlightSchedule(added, flights.size() - 1);
+    markChanged(added);
+    return added.getFlightId();
+}
+
+ImportReport AirlineSystem::importFlights(const std::string& path) {
+    // The interactive path only accepts future departures, so imports don't either
+    time_t now = std::time(nullptr);
+    return importRows(path, [this, now](const CsvRow& row) {
+        Flight flight(std::string(row.text(0)), std::string(row.text(1)), std::string(row.text(2)),
+                      static_cast<time_t>(row.toInt64(3)), row.toInt(4), row.toDouble(5));
+        if (!InputValidator::validateFlightNumber(flight.getFlightNumber())) {
+            throw InvalidInputException("flight number");
+        }
+        if (flight.getDepartureTime() <= now) {
+            throw InvalidInputException("departure time");
+        }
+        file_manager.validateFlightData(flight);
+        insertFlight(flight);
+    });
+}
+
 Flight* AirlineSystem::findFlight(int flight_id) {
-    auto it = std::find_if(flights.begin(), flights.end(),
-        [flight_id](const Flight& f) { 
-            return f.getFlightId() == flight_id && !f.isDeleted(); 
-        });
-    return it != flights.end() ? &(*it) : nullptr;
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    return findFlightUnlocked(flight_id);
+}
+
+Flight* AirlineSystem::findFlightUnlocked(int flight_id) {
+    return lookupSlot(flight_slots, flights, flight_id);
+}
+
+std::vector<Flight*> AirlineSystem::findFlightsDepartingBetween(time_t from, time_t to) {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    return findFlightsDepartingBetweenUnlocked(from, to);
+}
+
+std::vector<Flight*> AirlineSystem::findFlightsDepartingBetweenUnlocked(time_t from, time_t to) {
+    std::vector<Flight*> results;
+    if (from >= to) return results;
+
+    auto end = flights_by_departure.lower_bound(to);
+    for (auto it = flights_by_departure.lower_bound(from); it != end; ++it) {
+        results.push_back(&flights[it->second]);
+    }
+    return results;
+}
+
+std::vector<Flight*> AirlineSystem::searchFlights(const std::string& origin, const std::string& destination,
+                                                  time_t date, int days_flexible) {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::vector<Flight*> results;
+    auto route = flights_by_route.find({origin, destination});
+    if (route == flights_by_route.end()) return results;
+
+    const auto& schedule = route->second;
+    auto end = schedule.lower_bound(LocalTime::dayStart(date, days_flexible + 1));
+    for (auto it = schedule.lower_bound(LocalTime::dayStart(date, -days_flexible)); it != end; ++it) {
+        results.push_back(&flights[it->second]);
+    }
+    return results;
 }
 
 std::vector<Flight> AirlineSystem::searchFlights(const std::string& search_term) {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
     std::vector<Flight> results;
     for (const auto& f : flights) {
         if (f.isDeleted()) continue;
@@ -154,108 +963,246 @@ std::vector<Flight> AirlineSystem::searchFlights(const std::string& search_term)
 }
 
 Reservation* AirlineSystem::findReservation(int reservation_id) {
-    auto it = std::find_if(reservations.begin(), reservations.end(),
-        [reservation_id](const Reservation& r) { 
-            return r.getReservationId() == reservation_id && !r.isDeleted(); 
-        });
-    return it != reservations.end() ? &(*it) : nullptr;
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> lock(reservations_mutex);
+    return findReservationUnlocked(reservation_id);
 }
 
-void AirlineSystem::validateReservation(int passenger_id, int flight_id) {
-    auto passenger = findPassenger(passenger_id);
+ReservationTotals AirlineSystem::reservationTotals() const {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> lock(reservations_mutex);
+    return reservation_columns.totals();
+}
+
+Reservation* AirlineSystem::findReservationUnlocked(int reservation_id) {
+    return lookupSlot(reservation_slots, reservations, reservation_id);
+}
+
+ReservationError AirlineSystem::checkReservation(int passenger_id, int flight_id) {
+    auto passenger = findPassengerUnlocked(passenger_id);
     if (!passenger) {
-        throw PassengerNotFoundException();
+        return ReservationError::PassengerNotFound;
     }
     
-    auto flight = findFlight(flight_id);
+    auto flight = findFlightUnlocked(flight_id);
     if (!flight) {
-        throw FlightNotFoundException();
+        return ReservationError::FlightNotFound;
     }
     
     if (flight->getAvailableSeats() <= 0) {
-        throw AirlineException("Flight is full");
+        return ReservationError::FlightFull;
     }
     
     if (passenger->getWalletBalance() < flight->getTicketPrice()) {
-        throw InsufficientBalanceException();
+        return ReservationError::InsufficientBalance;
+    }
+    return ReservationError::None;
+}
+
+void AirlineSystem::validateReservation(int passenger_id, int flight_id) {
+    switch (checkReservation(passenger_id, flight_id)) {
+        case ReservationError::PassengerNotFound: throw PassengerNotFoundException();
+        case ReservationError::FlightNotFound: throw FlightNotFoundException();
+        case ReservationError::FlightFull: throw AirlineException("Flight is full");
+        case ReservationError::InsufficientBalance: throw InsufficientBalanceException();
+        default: break;
     }
 }
 
 int AirlineSystem::makeReservation(int passenger_id, int flight_id) {
+    int reservation_id;
     try {
+        // Bookings only share the catalog lock; seats are taken lock-free, so buyers
+        // of one hot flight serialise on nothing but its seat counter
+        std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+        std::lock_guard<std::mutex> passenger_stripe(passengerLock(passenger_id));
         validateReservation(passenger_id, flight_id);
-        auto passenger = findPassenger(passenger_id);
-        auto flight = findFlight(flight_id);
-        
-        passenger->updateWalletBalance(-flight->getTicketPrice());
-        flight->reserveSeat();
+        auto passenger = findPassengerUnlocked(passenger_id);
+        auto flight = findFlightUnlocked(flight_id);
         
         Reservation reservation(passenger_id, flight_id, flight->getTicketPrice());
         reservation.setFlightDepartureTime(flight->getDepartureTime()); // Set departure time
-        reservations.push_back(reservation);
-        
-        markDataAsChanged();
-        autoSave();
-        
-        return reservation.getReservationId();
+        file_manager.validateReservationData(reservation);
+
+        // The seat is the contended resource, so take it before touching the wallet
+        if (!flight->reserveSeat()) {
+            throw AirlineException("Flight is full");
+        }
+        passenger->updateWalletBalance(-flight->getTicketPrice());
+        try {
+            reservation.setReservationId(reservation_ids.next());
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            reservations.push_back(reservation);
+            last_reservation_id = std::max(last_reservation_id, reservation.getReservationId());
+            indexSlot(reservation_slots, reservations, reservation.getReservationId(), reservations.size() - 1);
+            indexReservationLinks(reservation, reservations.size() - 1);
+            reservation_columns.append(reservation, reservation.getFlightDepartureTime());
+        } catch (...) {
+            passenger->updateWalletBalance(flight->getTicketPrice());
+            flight->cancelSeat();
+            throw;
+        }
+        {
+            // One changes_mutex hold, so no flush can journal the debit without the reservation
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            std::lock_guard<std::mutex> changes(changes_mutex);
+            markChangedUnlocked(*passenger);
+            markChangedUnlocked(*flight);
+            markChangedUnlocked(reservation);
+        }
+        reservation_id = reservation.getReservationId();
     } catch (const std::exception& e) {
         throw AirlineException("Failed to make reservation: " + std::string(e.what()));
     }
+    autoSave();
+    return reservation_id;
 }
 
-bool AirlineSystem::cancelReservation(int reservation_id) {
-    auto reservation = findReservation(reservation_id);
-    if (!reservation) {
-        throw ReservationNotFoundException();
-    }
-    
-    if (reservation->isCancelled()) {
-        throw AirlineException("Reservation is already cancelled");
-    }
+std::vector<ReservationResult> AirlineSystem::makeReservations(const std::vector<ReservationRequest>& requests) {
+    std::vector<ReservationResult> results(requests.size());
+    {
+        // A batch is a bulk change, so it holds the catalog exclusively instead of
+        // taking a stripe per booking
+        std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+        std::vector<Reservation> booked;
+        std::vector<size_t> booked_items;
+        std::vector<Passenger*> touched_passengers;
+        std::vector<Flight*> touched_flights;
+        for (size_t i = 0; i < requests.size(); ++i) {
+            const ReservationRequest& request = requests[i];
+            ReservationError error = checkReservation(request.passenger_id, request.flight_id);
+            if (error != ReservationError::None) {
+                results[i].error = error;
+                continue;
+            }
+            auto passenger = findPassengerUnlocked(request.passenger_id);
+            auto flight = findFlightUnlocked(request.flight_id);
+
+            Reservation reservation(request.passenger_id, request.flight_id, flight->getTicketPrice());
+            reservation.setFlightDepartureTime(flight->getDepartureTime());
+            try {
+                file_manager.validateReservationData(reservation);
+            } catch (const InvalidInputException&) {
+                results[i].error = ReservationError::InvalidData;
+                continue;
+            }
+
+            if (!flight->reserveSeat()) {
+                results[i].error = ReservationError::FlightFull;
+                continue;
+            }
+            passenger->updateWalletBalance(-flight->getTicketPrice());
+            booked.push_back(std::move(reservation));
+            booked_items.push_back(i);
+            touched_passengers.push_back(passenger);
+            touched_flights.push_back(flight);
+        }
 
-    auto flight = findFlight(reservation->getFlightId());
-    if (!flight) {
-        throw FlightNotFoundException();
-    }
+        // One block of ids for the whole batch, in request order
+        int next_id = booked.empty() ? 0 : reservation_ids.reserveBlock(static_cast<int>(booked.size()));
+        for (size_t b = 0; b < booked.size(); ++b) {
+            booked[b].setReservationId(next_id + static_cast<int>(b));
+            reservations.push_back(booked[b]);
+            indexSlot(reservation_slots, reservations, booked[b].getReservationId(), reservations.size() - 1);
+            indexReservationLinks(booked[b], reservations.size() - 1);
+            reservation_columns.append(booked[b], booked[b].getFlightDepartureTime());
+            results[booked_items[b]].reservation_id = booked[b].getReservationId();
+        }
+        if (!booked.empty()) {
+            last_reservation_id = std::max(last_reservation_id, booked.back().getReservationId());
+        }
 
-    auto passenger = findPassenger(reservation->getPassengerId());
-    if (!passenger) {
-        throw PassengerNotFoundException();
+        // Each changed passenger and flight is journaled once, with its final state,
+        // and the whole batch under one changes_mutex hold so it stays one record
+        dropDuplicates(touched_passengers);
+        dropDuplicates(touched_flights);
+        std::lock_guard<std::mutex> changes(changes_mutex);
+        for (const Reservation& reservation : booked) markChangedUnlocked(reservation);
+        for (const Passenger* passenger : touched_passengers) markChangedUnlocked(*passenger);
+        for (const Flight* flight : touched_flights) markChangedUnlocked(*flight);
     }
+    autoSave();
+    return results;
+}
 
-    try {
-        double refund = reservation->calculateRefundAmount(std::time(nullptr));
-        passenger->updateWalletBalance(refund);
-        flight->cancelSeat();
-        reservation->cancel();
-        
-        markDataAsChanged();
-        autoSave();
-        
-        return true;
-    } catch (const FlightCompletedException& e) {
-        throw;  // Re-throw
-    } catch (const RefundNotAllowedException& e) {
-        throw;  // Re-throw
-    } catch (const std::exception& e) {
-        throw AirlineException("Error during cancellation: " + std::string(e.what()));
+bool AirlineSystem::cancelReservation(int reservation_id) {
+    {
+        std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+        Reservation* reservation;
+        int passenger_id;
+        int flight_id;
+        {
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            reservation = findReservationUnlocked(reservation_id);
+            if (!reservation) {
+                throw ReservationNotFoundException();
+            }
+            // A reservation's passenger never changes, so it picks the stripe
+            passenger_id = reservation->getPassengerId();
+            flight_id = reservation->getFlightId();
+        }
+        std::lock_guard<std::mutex> passenger_stripe(passengerLock(passenger_id));
+
+        if (reservation->isCancelled()) {
+            throw AirlineException("Reservation is already cancelled");
+        }
+
+        auto flight = findFlightUnlocked(flight_id);
+        if (!flight) {
+            throw FlightNotFoundException();
+        }
+
+        auto passenger = findPassengerUnlocked(passenger_id);
+        if (!passenger) {
+            throw PassengerNotFoundException();
+        }
+
+        try {
+            double refund = reservation->calculateRefundAmount(std::time(nullptr));
+            // A flight already back at capacity disagrees with its reservations, so refund nothing
+            if (!flight->cancelSeat()) {
+                throw AirlineException("Flight " + std::to_string(flight_id) + " has no reserved seat to release");
+            }
+            passenger->updateWalletBalance(refund);
+
+            // Reports read reservation states under reservations_mutex
+            std::lock_guard<std::mutex> lock(reservations_mutex);
+            reservation->cancel();
+            reservation_columns.refresh(reservation_slots.at(reservation_id), *reservation);
+            std::lock_guard<std::mutex> changes(changes_mutex);
+            markChangedUnlocked(*passenger);
+            markChangedUnlocked(*flight);
+            markChangedUnlocked(*reservation);
+        } catch (const FlightCompletedException& e) {
+            throw;  // Re-throw
+        } catch (const RefundNotAllowedException& e) {
+            throw;  // Re-throw
+        } catch (const std::exception& e) {
+            throw AirlineException("Error during cancellation: " + std::string(e.what()));
+        }
     }
+    autoSave();
+    return true;
 }
 
 void AirlineSystem::generateFlightReport(int flight_id) {
-    auto flight = findFlight(flight_id);
+    // Reports only read, so bookings keep running alongside them. The shared catalog lock
+    // holds the rows in place, reservations_mutex the reservation states and columns;
+    // seat counts are atomic.
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> io(persist_mutex);
+    auto flight = findFlightUnlocked(flight_id);
     if (!flight) throw std::runtime_error("Flight not found");
     
     std::stringstream report;
-    std::time_t t = flight->getDepartureTime();
     char time_str[26];
-    ctime_s(time_str, sizeof(time_str), &t);
+    LocalTime::formatCtime(flight->getDepartureTime(), time_str);
 
     report << "Flight Report\n";
     report << "Flight ID: " << flight->getFlightId() << "\n";
     report << "Flight Number: " << flight->getFlightNumber() << "\n";
     report << "From: " << flight->getOrigin() << " To: " << flight->getDestination() << "\n";
-    report << "Departure Time: " << time_str;  // ctime_s adds a newline
+    report << "Departure Time: " << time_str;  // formatCtime adds a newline
     report << "Available Seats: " << flight->getAvailableSeats() << "\n";
     report << "Ticket Price: $" << std::fixed << std::setprecision(2) << flight->getTicketPrice() << "\n";
     
@@ -264,7 +1211,12 @@ void AirlineSystem::generateFlightReport(int flight_id) {
 }
 
 void AirlineSystem::generatePassengerReport(int passenger_id) {
-    auto passenger = findPassenger(passenger_id);
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    // The report shows the wallet, which only the passenger's stripe holds still
+    std::lock_guard<std::mutex> passenger_stripe(passengerLock(passenger_id));
+    std::lock_guard<std::mutex> lock(reservations_mutex);
+    std::lock_guard<std::mutex> io(persist_mutex);
+    auto passenger = findPassengerUnlocked(passenger_id);
     if (!passenger) {
         throw PassengerNotFoundException();
     }
@@ -274,6 +1226,9 @@ void AirlineSystem::generatePassengerReport(int passenger_id) {
 }
 
 void AirlineSystem::generateReservationReport() {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> lock(reservations_mutex);
+    std::lock_guard<std::mutex> io(persist_mutex);
     std::string filename = "reservations_report.txt";
     file_manager.generateReservationsReport(filename, reservations, passengers, flights);
 }
@@ -291,6 +1246,7 @@ void AirlineSystem::displayPassengerDetails(const Passenger& passenger) {
 }
 
 void AirlineSystem::listAllPassengers() {
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
     std::cout << "\nAll Passengers:\n"
               << "--------------\n";
     for (const auto& passenger : passengers) {
@@ -302,20 +1258,22 @@ void AirlineSystem::listAllPassengers() {
 }
 
 void AirlineSystem::displayFlightDetails(const Flight& flight) {
-    std::time_t t = flight.getDepartureTime();
+    char time_str[26];
+    LocalTime::formatCtime(flight.getDepartureTime(), time_str);
     std::cout << "\nFlight Details:\n"
               << "----------------\n"
               << "ID: " << flight.getFlightId() << "\n"
               << "Flight Number: " << flight.getFlightNumber() << "\n"
               << "From: " << flight.getOrigin() << "\n"
               << "To: " << flight.getDestination() << "\n"
-              << "Departure Time: " << std::ctime(&t)
+              << "Departure Time: " << time_str
               << "Available Seats: " << flight.getAvailableSeats() << "\n"
               << "Ticket Price: $" << std::fixed << std::setprecision(2) 
               << flight.getTicketPrice() << "\n";
 }
 
 void AirlineSystem::listAllFlights() {
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
     std::cout << "\nAll Flights:\n"
               << "--------------\n";
     for (const auto& flight : flights) {
@@ -327,6 +1285,7 @@ void AirlineSystem::listAllFlights() {
 }
 
 void AirlineSystem::listAllReservations() {
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
     std::cout << "\nAll Reservations:\n"
               << "-----------------\n";
     bool found = false;
@@ -334,8 +1293,8 @@ void AirlineSystem::listAllReservations() {
     for (const auto& res : reservations) {
         if (res.isDeleted()) continue;
         
-        auto passenger = findPassenger(res.getPassengerId());
-        auto flight = findFlight(res.getFlightId());
+        auto passenger = findPassengerUnlocked(res.getPassengerId());
+        auto flight = findFlightUnlocked(res.getFlightId());
         
         if (passenger && flight) {
             found = true;
@@ -357,7 +1316,8 @@ void AirlineSystem::listAllReservations() {
 }
 
 void AirlineSystem::listPassengerReservations(int passenger_id) {
-    auto passenger = findPassenger(passenger_id);
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+    auto passenger = findPassengerUnlocked(passenger_id);
     if (!passenger) {
         throw PassengerNotFoundException();
     }
@@ -366,10 +1326,11 @@ void AirlineSystem::listPassengerReservations(int passenger_id) {
               << "-----------------\n";
     bool found = false;
     
-    for (const auto& res : reservations) {
-        if (res.isDeleted() || res.getPassengerId() != passenger_id) continue;
+    for (size_t slot : reservationSlotsOfPassenger(passenger_id)) {
+        const auto& res = reservations[slot];
+        if (res.isDeleted()) continue;
         
-        auto flight = findFlight(res.getFlightId());
+        auto flight = findFlightUnlocked(res.getFlightId());
         if (flight) {
             found = true;
             std::cout << "Reservation ID: " << res.getReservationId() << "\n"
@@ -391,70 +1352,93 @@ bool AirlineSystem::updatePassenger(int passenger_id, const std::string& name,
                                   const std::string& passport_number,
                                   const std::string& national_id,
                                   const std::string& nationality) {
-    auto passenger = findPassenger(passenger_id);
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+    auto passenger = findPassengerUnlocked(passenger_id);
     if (!passenger) {
         throw PassengerNotFoundException();
     }
 
     // Check if new passport or national ID is already taken by another passenger
-    if (isPassportNumberTaken(passport_number, passenger_id)) {
+    if (isPassportNumberTakenUnlocked(passport_number, passenger_id)) {
         throw AirlineException("This passport number is already registered to another passenger");
     }
-    if (isNationalIdTaken(national_id, passenger_id)) {
+    if (isNationalIdTakenUnlocked(national_id, passenger_id)) {
         throw AirlineException("This national ID is already registered to another passenger");
     }
 
-    passenger->setName(name);
-    passenger->setPassportNumber(passport_number);
-    passenger->setNationalId(national_id);
-    passenger->setNationality(nationality);
+    Passenger updated = *passenger;
+    updated.setName(name);
+    updated.setPassportNumber(passport_number);
+    updated.setNationalId(national_id);
+    updated.setNationality(nationality);
+    file_manager.validatePassengerData(updated);
+
+    size_t slot = passenger_slots.at(passenger_id);
+    unindexPassenger(*passenger, slot);
+    *passenger = std::move(updated);
+    indexPassenger(*passenger, slot);
 
-    markDataAsChanged();
+    markChanged(*passenger);
+    catalog.unlock();
     autoSave();
     return true;
 }
 
 bool AirlineSystem::deleteFlight(int flight_id) {
-    auto flight = findFlight(flight_id);
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+    auto flight = findFlightUnlocked(flight_id);
     if (!flight) {
         throw FlightNotFoundException();
     }
 
     // Check if flight has active reservations
-    auto hasActiveReservations = std::any_of(reservations.begin(), reservations.end(),
-        [flight_id](const Reservation& r) {
-            return r.getFlightId() == flight_id && !r.isCancelled() && !r.isDeleted();
+    const auto& slots = reservationSlotsOfFlight(flight_id);
+    auto hasActiveReservations = std::any_of(slots.begin(), slots.end(),
+        [this](size_t slot) {
+            const Reservation& r = reservations[slot];
+            return !r.isCancelled() && !r.isDeleted();
         });
 
     if (hasActiveReservations) {
         throw AirlineException("Cannot delete flight with active reservations");
     }
 
+    unindexFlightSchedule(*flight, flight_slots.at(flight_id));
     flight->softDelete();
-    markDataAsChanged();
+    ++dead_rows;
+    markChanged(*flight);
+    catalog.unlock();
     autoSave();
+    compactIfDue();
     return true;
 }
 
 bool AirlineSystem::deletePassenger(int passenger_id) {
-    auto passenger = findPassenger(passenger_id);
+    std::unique_lock<std::shared_mutex> catalog(catalog_mutex);
+    auto passenger = findPassengerUnlocked(passenger_id);
     if (!passenger) {
         throw PassengerNotFoundException();
     }
 
     // Check for active reservations
-    auto hasActiveReservations = std::any_of(reservations.begin(), reservations.end(),
-        [passenger_id](const Reservation& r) {
-            return r.getPassengerId() == passenger_id && !r.isCancelled() && !r.isDeleted();
+    const auto& slots = reservationSlotsOfPassenger(passenger_id);
+    auto hasActiveReservations = std::any_of(slots.begin(), slots.end(),
+        [this](size_t slot) {
+            const Reservation& r = reservations[slot];
+            return !r.isCancelled() && !r.isDeleted();
         });
 
     if (hasActiveReservations) {
         throw AirlineException("Cannot delete passenger with active reservations");
     }
 
+    unindexPassenger(*passenger, passenger_slots.at(passenger_id));
     passenger->softDelete();
-    markDataAsChanged();
+    ++dead_rows;
+    markChanged(*passenger);
+    catalog.unlock();
     autoSave();
+    compactIfDue();
     return true;
 }
 
@@ -463,119 +1447,100 @@ bool AirlineSystem::isFlightCompleted(const Flight& flight) const {
 }
 
 bool AirlineSystem::isFlightOnDate(const Flight& flight, time_t date) const {
-    time_t flight_time = flight.getDepartureTime();
-    tm* flight_tm = localtime(&flight_time);
-    tm* date_tm = localtime(&date);
-    return flight_tm->tm_year == date_tm->tm_year &&
-           flight_tm->tm_mon == date_tm->tm_mon &&
-           flight_tm->tm_mday == date_tm->tm_mday;
+    return LocalTime::dayNumber(flight.getDepartureTime()) == LocalTime::dayNumber(date);
 }
 
 void AirlineSystem::generateReservationsReport(const std::string& filename, bool futureOnly, bool completedOnly, bool refundedOnly) {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> lock(reservations_mutex);
     std::ofstream outfile(filename);
     if (!outfile) throw FileOperationException("Could not create report file");
 
-    outfile << "Reservation ID,Passenger Name,Flight Number,Date,Status,Amount\n";
-
-    for (const auto& res : reservations) {
-        if (res.isDeleted()) continue;
-
-        auto flight = findFlight(res.getFlightId());
-        auto passenger = findPassenger(res.getPassengerId());
-        if (!flight || !passenger) continue;
-
-        bool isCompleted = isFlightCompleted(*flight);
-        
-        if (futureOnly && isCompleted) continue;
-        if (completedOnly && !isCompleted) continue;
-        if (refundedOnly && !res.isCancelled()) continue;
-
-        std::time_t t = flight->getDepartureTime();
-        char date_str[11];
-        std::strftime(date_str, sizeof(date_str), "%Y-%m-%d", std::localtime(&t));
-
-        outfile << res.getReservationId() << ","
-             << passenger->getName() << ","
-             << flight->getFlightNumber() << ","
-             << date_str << ","
-             << (res.isCancelled() ? "Refunded" : (isCompleted ? "Completed" : "Future")) << ","
-             << res.getAmountPaid() << "\n";
-    }
+    outfile << RESERVATIONS_REPORT_HEADER;
+
+    // The filters are applied on the column store; only matching rows are read whole
+    ReservationFilter filter;
+    filter.now = std::time(nullptr);
+    filter.future_only = futureOnly;
+    filter.completed_only = completedOnly;
+    filter.cancelled_only = refundedOnly;
+    std::vector<size_t> slots = reservation_columns.select(filter);
+    writeOrdered(outfile, &workers, slots.size(), [&](std::ostream& out, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t slot = slots[i];
+            auto flight = findFlightUnlocked(reservation_columns.flightId(slot));
+            auto passenger = findPassengerUnlocked(reservation_columns.passengerId(slot));
+            if (!flight || !passenger) continue;
+
+            writeReservationRow(out, reservations[slot], *passenger, *flight,
+                                reservation_columns.departure(slot) < filter.now);
+        }
+    });
 }
 
 void AirlineSystem::generateFlightPassengersReport(const std::string& filename, int flight_id) {
-    auto flight = findFlight(flight_id);
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> lock(reservations_mutex);
+    auto flight = findFlightUnlocked(flight_id);
     if (!flight) throw FlightNotFoundException();
 
     std::ofstream outfile(filename);
     if (!outfile) throw FileOperationException("Could not create report file");
 
     outfile << "Flight: " << flight->getFlightNumber() << "\n";
-    outfile << "Passenger ID,Name,Passport,Nationality,Status\n";
+    outfile << FLIGHT_PASSENGERS_REPORT_HEADER;
 
-    for (const auto& res : reservations) {
-        if (res.isDeleted() || res.getFlightId() != flight_id) continue;
+    for (size_t slot : reservationSlotsOfFlight(flight_id)) {
+        const auto& res = reservations[slot];
+        if (res.isDeleted()) continue;
 
-        auto passenger = findPassenger(res.getPassengerId());
+        auto passenger = findPassengerUnlocked(res.getPassengerId());
         if (!passenger) continue;
 
-        outfile << passenger->getPassengerId() << ","
-             << passenger->getName() << ","
-             << passenger->getPassportNumber() << ","
-             << passenger->getNationality() << ","
-             << (res.isCancelled() ? "Cancelled" : "Confirmed") << "\n";
+        writeFlightPassengerRow(outfile, *passenger, res);
     }
 }
 
 void AirlineSystem::generateFlightsByDateReport(const std::string& filename, time_t date) {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
     std::ofstream outfile(filename);
     if (!outfile) throw FileOperationException("Could not create report file");
 
     outfile << "Flight Number,Origin,Destination,Time,Available Seats,Status\n";
 
-    for (const auto& flight : flights) {
-        if (flight.isDeleted() || !isFlightOnDate(flight, date)) continue;
-
-        std::time_t t = flight.getDepartureTime();
+    for (const Flight* flight : findFlightsDepartingBetweenUnlocked(LocalTime::dayStart(date, 0), LocalTime::dayStart(date, 1))) {
         char time_str[9];
-        std::strftime(time_str, sizeof(time_str), "%H:%M:%S", std::localtime(&t));
+        LocalTime::formatTime(flight->getDepartureTime(), time_str);
 
-        outfile << flight.getFlightNumber() << ","
-             << flight.getOrigin() << ","
-             << flight.getDestination() << ","
+        outfile << flight->getFlightNumber() << ","
+             << flight->getOrigin() << ","
+             << flight->getDestination() << ","
              << time_str << ","
-             << flight.getAvailableSeats() << ","
-             << (isFlightCompleted(flight) ? "Completed" : "Scheduled") << "\n";
+             << flight->getAvailableSeats() << ","
+             << (isFlightCompleted(*flight) ? "Completed" : "Scheduled") << "\n";
     }
 }
 
 void AirlineSystem::generateFutureFlightsReport(const std::string& filename) {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
     std::ofstream outfile(filename);
     if (!outfile) throw FileOperationException("Could not create report file");
 
-    outfile << "Flight Number,Origin,Destination,Date,Time,Available Seats,Price\n";
+    outfile << FUTURE_FLIGHTS_REPORT_HEADER;
 
     time_t now = std::time(nullptr);
-    for (const auto& flight : flights) {
-        if (flight.isDeleted() || flight.getDepartureTime() <= now) continue;
-
-        std::time_t t = flight.getDepartureTime();
-        char date_str[11], time_str[9];
-        std::strftime(date_str, sizeof(date_str), "%Y-%m-%d", std::localtime(&t));
-        std::strftime(time_str, sizeof(time_str), "%H:%M:%S", std::localtime(&t));
-
-        outfile << flight.getFlightNumber() << ","
-             << flight.getOrigin() << ","
-             << flight.getDestination() << ","
-             << date_str << ","
-             << time_str << ","
-             << flight.getAvailableSeats() << ","
-             << flight.getTicketPrice() << "\n";
-    }
+    std::vector<Flight*> future = findFlightsDepartingBetweenUnlocked(now + 1, std::numeric_limits<time_t>::max());
+    writeOrdered(outfile, &workers, future.size(), [&](std::ostream& out, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            writeFutureFlightRow(out, *future[i]);
+        }
+    });
 }
 
 void AirlineSystem::generatePassengerTripsReport(const std::string& filename, int passenger_id, bool futureOnly, bool refundedOnly) {
-    auto passenger = findPassenger(passenger_id);
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> lock(reservations_mutex);
+    auto passenger = findPassengerUnlocked(passenger_id);
     if (!passenger) throw PassengerNotFoundException();
 
     std::ofstream outfile(filename);
@@ -584,19 +1549,21 @@ void AirlineSystem::generatePassengerTripsReport(const std::string& filename, in
     outfile << "Passenger: " << passenger->getName() << "\n";
     outfile << "Flight Number,Origin,Destination,Date,Status,Amount\n";
 
-    for (const auto& res : reservations) {
-        if (res.isDeleted() || res.getPassengerId() != passenger_id) continue;
-        if (refundedOnly && !res.isCancelled()) continue;
+    // The adjacency list already narrows to this passenger; the filters are then
+    // tested on the columns, so rejected bookings never load their row or flight
+    time_t now = std::time(nullptr);
+    for (size_t slot : reservationSlotsOfPassenger(passenger_id)) {
+        if (reservation_columns.isDeleted(slot)) continue;
+        if (refundedOnly && !reservation_columns.isCancelled(slot)) continue;
+        bool isCompleted = reservation_columns.departure(slot) < now;
+        if (futureOnly && isCompleted) continue;
 
-        auto flight = findFlight(res.getFlightId());
+        auto flight = findFlightUnlocked(reservation_columns.flightId(slot));
         if (!flight) continue;
+        const auto& res = reservations[slot];
 
-        bool isCompleted = isFlightCompleted(*flight);
-        if (futureOnly && isCompleted) continue;
-
-        std::time_t t = flight->getDepartureTime();
         char date_str[11];
-        std::strftime(date_str, sizeof(date_str), "%Y-%m-%d", std::localtime(&t));
+        LocalTime::formatDate(flight->getDepartureTime(), date_str);
 
         outfile << flight->getFlightNumber() << ","
              << flight->getOrigin() << ","
@@ -606,3 +1573,133 @@ void AirlineSystem::generatePassengerTripsReport(const std::string& filename, in
              << res.getAmountPaid() << "\n";
     }
 }
+
+ReportSpec ReportSpec::reservations(const std::string& filename, bool future_only,
+                                    bool completed_only, bool refunded_only) {
+    ReportSpec spec;
+    spec.kind = Kind::Reservations;
+    spec.filename = filename;
+    spec.future_only = future_only;
+    spec.completed_only = completed_only;
+    spec.refunded_only = refunded_only;
+    return spec;
+}
+
+ReportSpec ReportSpec::futureFlights(const std::string& filename) {
+    ReportSpec spec;
+    spec.kind = Kind::FutureFlights;
+    spec.filename = filename;
+    return spec;
+}
+
+ReportSpec ReportSpec::flightPassengers(const std::string& filename, int flight_id) {
+    ReportSpec spec;
+    spec.kind = Kind::FlightPassengers;
+    spec.filename = filename;
+    spec.flight_id = flight_id;
+    return spec;
+}
+
+void AirlineSystem::generateReports(const std::vector<ReportSpec>& specs) {
+    std::shared_lock<std::shared_mutex> catalog(catalog_mutex);
+    std::lock_guard<std::mutex> lock(reservations_mutex);
+    // Every spec is checked and every file created before any row is written
+    for (const auto& spec : specs) {
+        if (spec.kind == ReportSpec::Kind::FlightPassengers && !findFlightUnlocked(spec.flight_id)) {
+            throw FlightNotFoundException();
+        }
+    }
+    std::vector<std::unique_ptr<std::ofstream>> files;
+    for (const auto& spec : specs) {
+        files.push_back(std::make_unique<std::ofstream>(spec.filename));
+        if (!*files.back()) throw FileOperationException("Could not create report file");
+    }
+
+    // Reservation reports are filled by the shared scan, future flight reports by one
+    // walk of the departure index
+    std::vector<std::ostream*> scan_outputs;
+    std::vector<const ReportSpec*> reservation_specs;            // parallel to the front of scan_outputs
+    std::unordered_map<int, std::vector<size_t>> flight_outputs; // flight id -> index in scan_outputs
+    std::vector<std::ostream*> future_outputs;
+    for (size_t i = 0; i < specs.size(); ++i) {
+        if (specs[i].kind == ReportSpec::Kind::Reservations) {
+            *files[i] << RESERVATIONS_REPORT_HEADER;
+            scan_outputs.push_back(files[i].get());
+            reservation_specs.push_back(&specs[i]);
+        }
+    }
+    for (size_t i = 0; i < specs.size(); ++i) {
+        if (specs[i].kind == ReportSpec::Kind::FlightPassengers) {
+            *files[i] << "Flight: " << findFlightUnlocked(specs[i].flight_id)->getFlightNumber() << "\n"
+                      << FLIGHT_PASSENGERS_REPORT_HEADER;
+            flight_outputs[specs[i].flight_id].push_back(scan_outputs.size());
+            scan_outputs.push_back(files[i].get());
+        } else if (specs[i].kind == ReportSpec::Kind::FutureFlights) {
+            *files[i] << FUTURE_FLIGHTS_REPORT_HEADER;
+            future_outputs.push_back(files[i].get());
+        }
+    }
+
+    time_t now = std::time(nullptr);
+    if (!scan_outputs.empty()) {
+        writeOrdered(scan_outputs, &workers, reservations.size(),
+                     [&](const std::vector<std::ostream*>& outs, size_t begin, size_t end) {
+            // A row kept by several reservation reports is formatted once and copied
+            std::ostringstream line;
+            line.copyfmt(*outs[0]);
+            std::string row;
+            for (size_t slot = begin; slot < end; ++slot) {
+                if (reservation_columns.isDeleted(slot)) continue;
+                bool cancelled = reservation_columns.isCancelled(slot);
+                bool completed = reservation_columns.departure(slot) < now;
+                auto flight_reports = flight_outputs.find(reservation_columns.flightId(slot));
+
+                // The join runs once per row, and only if some report keeps the row
+                bool joined = false;
+                const Passenger* passenger = nullptr;
+                const Flight* flight = nullptr;
+                auto join = [&]() {
+                    if (joined) return;
+                    joined = true;
+                    passenger = findPassengerUnlocked(reservation_columns.passengerId(slot));
+                    flight = findFlightUnlocked(reservation_columns.flightId(slot));
+                };
+
+                const Reservation& res = reservations[slot];
+                bool formatted = false;
+                for (size_t r = 0; r < reservation_specs.size(); ++r) {
+                    const ReportSpec& spec = *reservation_specs[r];
+                    if (spec.future_only && completed) continue;
+                    if (spec.completed_only && !completed) continue;
+                    if (spec.refunded_only && !cancelled) continue;
+                    join();
+                    if (!flight || !passenger) break;
+                    if (!formatted) {
+                        line.str(std::string());
+                        writeReservationRow(line, res, *passenger, *flight, completed);
+                        row = line.str();
+                        formatted = true;
+                    }
+                    *outs[r] << row;
+                }
+                if (flight_reports != flight_outputs.end()) {
+                    join();
+                    if (!passenger) continue;
+                    for (size_t output : flight_reports->second) {
+                        writeFlightPassengerRow(*outs[output], *passenger, res);
+                    }
+                }
+            }
+        });
+    }
+
+    if (!future_outputs.empty()) {
+        std::vector<Flight*> future = findFlightsDepartingBetweenUnlocked(now + 1, std::numeric_limits<time_t>::max());
+        writeOrdered(future_outputs, &workers, future.size(),
+                     [&](const std::vector<std::ostream*>& outs, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                for (std::ostream* out : outs) writeFutureFlightRow(*out, *future[i]);
+            }
+        });
+    }
+}
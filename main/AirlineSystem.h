@@ -1,26 +1,266 @@
 #pragma once
 #include <vector>
+#include <deque>
 #include <memory>
+#include <unordered_map>
+#include <map>
+#include <string>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <array>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
 #include "Passenger.h"
 #include "Flight.h"
 #include "Reservation.h"
 #include "FileManager.h"
 #include "AirlineExceptions.h"
+#include "TrigramIndex.h"
+#include "ThreadPool.h"
+#include "IdAllocator.h"
+#include "ReservationColumns.h"
 
+// One booking in a makeReservations batch
+struct ReservationRequest {
+    int passenger_id;
+    int flight_id;
+};
+
+// Why a booking was turned down; the codes match the exceptions makeReservation throws
+enum class ReservationError {
+    None,
+    PassengerNotFound,
+    FlightNotFound,
+    FlightFull,
+    InsufficientBalance,
+    InvalidData
+};
+
+struct ReservationResult {
+    int reservation_id = 0;                           // set when error is None
+    ReservationError error = ReservationError::None;
+
+    bool ok() const { return error == ReservationError::None; }
+};
+
+// A row a bulk import turned down, by its line number in the file
+struct ImportRejection {
+    size_t row;
+    std::string reason;
+};
+
+struct ImportReport {
+    size_t imported = 0;
+    std::vector<ImportRejection> rejected;
+};
+
+// One report of a generateReports batch, with the options of the matching generate*Report call
+struct ReportSpec {
+    enum class Kind {
+        Reservations,       // generateReservationsReport
+        FutureFlights,      // generateFutureFlightsReport
+        FlightPassengers    // generateFlightPassengersReport
+    };
+    Kind kind = Kind::Reservations;
+    std::string filename;
+    bool future_only = false;
+    bool completed_only = false;
+    bool refunded_only = false;
+    int flight_id = 0;
+
+    static ReportSpec reservations(const std::string& filename, bool future_only = false,
+                                   bool completed_only = false, bool refunded_only = false);
+    static ReportSpec futureFlights(const std::string& filename);
+    static ReportSpec flightPassengers(const std::string& filename, int flight_id);
+};
+
+// Rows of one table: live ones, and soft-deleted ones still kept in memory and on disk
+struct TableStats {
+    size_t live = 0;
+    size_t dead = 0;
+};
+
+struct StorageStats {
+    TableStats passengers;
+    TableStats flights;
+    TableStats reservations;
+};
+
+// All public methods are safe to call from several threads. Pointers returned by
+// find* stay valid until the next compaction, but a row they point at may be
+// changed by other threads.
 class AirlineSystem {
 private:
-    std::vector<Passenger> passengers;
-    std::vector<Flight> flights;
-    std::vector<Reservation> reservations;
+    // deque keeps the pointers handed out by find* valid when new rows are appended
+    std::deque<Passenger> passengers;
+    std::deque<Flight> flights;
+    std::deque<Reservation> reservations;
     FileManager file_manager;
-    bool data_changed;
+    // Shared workers for bulk work such as parsing large tables at startup
+    ThreadPool workers;
+
+    // Persistence state of one table: rows before persisted_rows are in its file,
+    // and rows from first_dirty on differ from it
+    struct TableState {
+        static constexpr size_t CLEAN = static_cast<size_t>(-1);
+        size_t persisted_rows = 0;
+        size_t first_dirty = CLEAN;
+
+        bool isDirty() const { return first_dirty != CLEAN; }
+        // Only rows past the end of the file changed, so the save can append
+        bool isAppendOnly() const { return first_dirty >= persisted_rows; }
+        void markRow(size_t slot) { if (slot < first_dirty) first_dirty = slot; }
+        void markAll() { first_dirty = 0; }
+        void markSaved(size_t rows) { persisted_rows = rows; first_dirty = CLEAN; }
+    };
+    TableState passenger_table;
+    TableState flight_table;
+    TableState reservation_table;
+
+    // Ids for new rows; rows built outside the system carry no id until they are added.
+    // Bookings allocate under the shared catalog lock, so reservation ids come from
+    // per-thread blocks; passengers and flights are added under the exclusive lock.
+    static constexpr int RESERVATION_ID_BLOCK = 64;
+    IdAllocator passenger_ids;
+    IdAllocator flight_ids;
+    IdAllocator reservation_ids{RESERVATION_ID_BLOCK};
+    // Highest reservation id handed out or loaded, under reservations_mutex. The saved
+    // sequence continues from it, not from the allocator, so a restart does not skip
+    // the unused rest of a thread's block.
+    int last_reservation_id = 0;
+    IdSequences sequences() const;
+
+    // Primary-key indexes: entity id -> slot in the containers above
+    std::unordered_map<int, size_t> passenger_slots;
+    std::unordered_map<int, size_t> flight_slots;
+    std::unordered_map<int, size_t> reservation_slots;
+
+    // Unique keys of live passengers -> passenger id
+    std::unordered_map<std::string, int> national_id_index;
+    std::unordered_map<std::string, int> passport_index;
+    // Substring search over name, passport number and national ID of live passengers
+    TrigramIndex passenger_text_index;
+
+    // Adjacency lists: passenger/flight id -> slots of its reservations, in booking order
+    std::unordered_map<int, std::vector<size_t>> passenger_reservations;
+    std::unordered_map<int, std::vector<size_t>> flight_reservations;
+    // Reservations again as columns, for report scans
+    ReservationColumns reservation_columns;
+
+    // Live flights ordered by departure time -> flight slot
+    std::multimap<time_t, size_t> flights_by_departure;
+    // (origin, destination) -> live flights of that route ordered by departure time
+    std::map<std::pair<std::string, std::string>, std::multimap<time_t, size_t>> flights_by_route;
 
+    void rebuildIndexes();
+    void inferFlightCapacities();
+    void indexPassenger(const Passenger& passenger, size_t slot);
+    void unindexPassenger(const Passenger& passenger, size_t slot);
+    void indexReservationLinks(const Reservation& reservation, size_t slot);
+    void indexReservationColumns(const Reservation& reservation);
+    const std::vector<size_t>& reservationSlotsOfPassenger(int passenger_id) const;
+    const std::vector<size_t>& reservationSlotsOfFlight(int flight_id) const;
+    void indexFlightSchedule(const Flight& flight, size_t slot);
+    void unindexFlightSchedule(const Flight& flight, size_t slot);
+    ReservationError checkReservation(int passenger_id, int flight_id);
     void validateReservation(int passenger_id, int flight_id);
-    void markDataAsChanged() { data_changed = true; }
+    // Insert a validated row under an exclusive catalog lock and return its new id
+    int insertPassenger(const Passenger& passenger);
+    int insertFlight(const Flight& flight);
+    // Shared body of the bulk imports: insert_row throws AirlineException to reject a row
+    ImportReport importRows(const std::string& path, const std::function<void(const CsvRow&)>& insert_row);
+    // Compaction: soft-deleted rows counted since the last rebuild, and the automatic trigger
+    size_t dead_rows = 0;
+    size_t dead_rows_kept = 0;   // tombstones the last compaction had to keep
+    bool auto_compact = false;
+    double compact_dead_ratio = 0.3;
+    size_t compact_min_rows = 1000;
+    size_t compactUnlocked();
+    void compactIfDue();
+    // Journaling: mutations append their changed rows to the journal instead of rewriting every file
+    bool journaling = false;
+    size_t checkpoint_interval = 1000;
+    size_t journal_records = 0;
+    std::string pending_journal;
+
+    // Locks, always taken in this order:
+    //   catalog_mutex       shared by lookups, bookings, wallet changes and reports;
+    //                       exclusive for anything that adds, removes or re-keys rows and
+    //                       for capturing a snapshot
+    //   passenger stripe    wallet and reservation states of the passengers hashing to it
+    //   reservations_mutex  reservations, reservation_slots, the adjacency lists and columns;
+    //                       a cancellation changes the reservation state under it too, so
+    //                       reports hold it instead of every stripe
+    //   changes_mutex       table dirty state, journaling settings and the pending journal
+    //   persist_mutex       file_manager
+    // Flight seats need no lock: Flight keeps them in an atomic counter.
+    mutable std::shared_mutex catalog_mutex;
+    static constexpr size_t LOCK_STRIPES = 64;
+    mutable std::array<std::mutex, LOCK_STRIPES> passenger_locks;
+    mutable std::mutex reservations_mutex;
+    mutable std::mutex changes_mutex;
+    std::mutex persist_mutex;
+
+    std::mutex& passengerLock(int passenger_id) const {
+        return passenger_locks[static_cast<size_t>(passenger_id) % LOCK_STRIPES];
+    }
+
+    // Lookups for callers that already hold catalog_mutex (and reservations_mutex for reservations)
+    Passenger* findPassengerUnlocked(int passenger_id);
+    Flight* findFlightUnlocked(int flight_id);
+    Reservation* findReservationUnlocked(int reservation_id);
+    std::vector<Flight*> findFlightsDepartingBetweenUnlocked(time_t from, time_t to);
+    bool isNationalIdTakenUnlocked(const std::string& national_id, int exclude_id) const;
+    bool isPassportNumberTakenUnlocked(const std::string& passport, int exclude_id) const;
+
+    // Background flushing: mutations only count themselves, and the flusher thread
+    // writes the coalesced changes every flush_interval or every flush_operations mutations
+    std::atomic<bool> background_flush{false};
+    std::thread flusher;
+    std::mutex flush_mutex;
+    std::condition_variable flush_wakeup;
+    bool flusher_running = false;
+    size_t pending_operations = 0;
+    size_t flush_operations = 100;
+    std::chrono::milliseconds flush_interval{200};
+
+    // Changes captured under catalog_mutex and changes_mutex, written once they are released
+    struct PendingFlush {
+        std::string journal;              // one journal record, or empty
+        bool snapshot = false;            // rewrite the snapshot and clear the journal
+        std::vector<TableImage> tables;   // CSV snapshot
+        std::string binary_image;         // binary snapshot
+        std::string folded_journal;       // unflushed journal lines the snapshot replaces
+        size_t folded_records = 0;        // journal records the snapshot replaces
+    };
+
+    void markChanged(const Passenger& passenger);
+    void markChanged(const Flight& flight);
+    void markChanged(const Reservation& reservation);
+    // The caller holds changes_mutex; an operation that changes several rows marks
+    // them all under one hold so a flush never journals part of it
+    void markChangedUnlocked(const Passenger& passenger);
+    void markChangedUnlocked(const Flight& flight);
+    void markChangedUnlocked(const Reservation& reservation);
     void autoSave();
+    void checkpoint();
+    bool hasDirtyTables() const;
+    // Writes every dirty table; the caller holds catalog_mutex exclusively and changes_mutex
+    void persistAll();
+    void saveCsvTables();
+    void saveBinaryTables();
+    void runFlusher();
+    void stopFlusher();
+    void flushPending();
+    PendingFlush captureFlush();
+    void writeFlush(const PendingFlush& batch);
+    void restoreFlush(const PendingFlush& batch);
 
 public:
-    AirlineSystem();
+    explicit AirlineSystem(SnapshotFormat format = SnapshotFormat::Csv);
     ~AirlineSystem();
 
     // Passenger management
@@ -28,16 +268,37 @@ public:
     Passenger* findPassenger(int passenger_id);
     std::vector<Passenger> searchPassengers(const std::string& search_term);
     bool deletePassenger(int passenger_id);
+    bool updateWalletBalance(int passenger_id, double amount);
 
     // Flight management
     int addFlight(const Flight& flight);
     Flight* findFlight(int flight_id);
     std::vector<Flight> searchFlights(const std::string& search_term);
+    // Flights on one route departing on the local day of `date`, widened by days_flexible either side
+    std::vector<Flight*> searchFlights(const std::string& origin, const std::string& destination,
+                                       time_t date, int days_flexible = 0);
+    // Live flights departing in [from, to), earliest first
+    std::vector<Flight*> findFlightsDepartingBetween(time_t from, time_t to);
 
     // Reservation management
     int makeReservation(int passenger_id, int flight_id);
+    // Books the requests in order and saves them as one commit. A booking that
+    // fails is reported in its result and does not stop the rest of the batch.
+    std::vector<ReservationResult> makeReservations(const std::vector<ReservationRequest>& requests);
     bool cancelReservation(int reservation_id);
     Reservation* findReservation(int reservation_id);
+    // Counts and amounts over every live reservation, from the column store
+    ReservationTotals reservationTotals() const;
+
+    // Bulk import, streamed from headerless CSV files with one commit per file:
+    //   passengers: name,passport_number,national_id,nationality
+    //   flights:    flight_number,origin,destination,departure_time,available_seats,ticket_price
+    // departure_time is in Unix seconds, as in flights.csv, and must be in the future.
+    // Rows that fail parsing, InputValidator's format rules or the duplicate checks are
+    // skipped and reported. An unexpected error part way through ends the import as its
+    // last rejected row; the rows imported before it are kept and saved.
+    ImportReport importPassengers(const std::string& path);
+    ImportReport importFlights(const std::string& path);
 
     // Report generation
     void generateFlightReport(int flight_id);
@@ -48,16 +309,42 @@ public:
     void generateFlightsByDateReport(const std::string& filename, time_t date);
     void generateFutureFlightsReport(const std::string& filename);
     void generatePassengerTripsReport(const std::string& filename, int passenger_id, bool futureOnly = false, bool refundedOnly = false);
+    // Writes every report in one shared pass: reservations are scanned and joined to
+    // their passenger and flight once, then fanned out to each report that keeps them.
+    // Each file matches what the single call would write.
+    void generateReports(const std::vector<ReportSpec>& specs);
 
     // File operations
     void saveAllData();
     void loadAllData();
 
     // New methods for better error handling and file management
-    bool hasUnsavedChanges() const { return data_changed; }
-    void forceSync() { saveAllData(); data_changed = false; }
+    bool hasUnsavedChanges() const;
+    // Synchronous barrier: returns once every change, including any a background flush holds, is on disk
+    void forceSync() { saveAllData(); }
+    // Checkpoints to the CSV snapshot after checkpoint_interval journal records
+    void setJournaling(bool enabled, size_t checkpoint_interval = 1000);
+    bool isJournaling() const;
+    void setDurability(Durability level);
+    // Moves persistence off the calling thread. Mutations return without touching the
+    // disk; forceSync() and the destructor still write everything before returning.
+    void setBackgroundFlush(bool enabled,
+                            std::chrono::milliseconds interval = std::chrono::milliseconds(200),
+                            size_t max_operations = 100);
+    bool isBackgroundFlush() const { return background_flush; }
     void ensureFileExists();
 
+    // Compaction: soft-deleted rows stay in memory and on disk until compacted.
+    // compact() drops deleted reservations and every deleted passenger or flight no
+    // remaining reservation refers to, rewrites the snapshot and rebuilds the indexes.
+    // Removed ids are never handed out again. Returns the number of rows removed.
+    size_t compact();
+    StorageStats storageStats() const;
+    // Compacts after a delete once at least min_rows tombstones have built up since the
+    // last compaction (or since loading) and tombstones make up at least dead_ratio of
+    // all rows. Enabling it checks the same rule straight away.
+    void setAutoCompact(bool enabled, double dead_ratio = 0.3, size_t min_rows = 1000);
+
     // Add new methods
     bool isNationalIdTaken(const std::string& national_id, int exclude_id = -1);
     bool isPassportNumberTaken(const std::string& passport, int exclude_id = -1);
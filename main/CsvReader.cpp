@@ -0,0 +1,76 @@
+#include "CsvReader.h"
+#include "AirlineExceptions.h"
+#include <charconv>
+#include <cstring>
+
+void CsvRow::parse(std::string_view line, size_t row_number) {
+    this->row_number = row_number;
+    count = 0;
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+
+    // Columns past MAX_FIELDS are ignored, as the old getline parsing ignored trailing fields
+    size_t start = 0;
+    while (count < MAX_FIELDS) {
+        size_t comma = line.find(',', start);
+        if (comma == std::string_view::npos) {
+            fields[count++] = line.substr(start);
+            break;
+        }
+        fields[count++] = line.substr(start, comma - start);
+        start = comma + 1;
+    }
+}
+
+std::string_view CsvRow::text(size_t column) const {
+    if (column >= count) {
+        fail(column, "missing field");
+    }
+    return fields[column];
+}
+
+namespace {
+
+template <typename T>
+T parseNumber(const CsvRow& row, size_t column, std::string_view field) {
+    T value{};
+    auto result = std::from_chars(field.data(), field.data() + field.size(), value);
+    if (result.ec != std::errc() || result.ptr != field.data() + field.size()) {
+        row.fail(column, "invalid number '" + std::string(field) + "'");
+    }
+    return value;
+}
+
+}
+
+int CsvRow::toInt(size_t column) const {
+    return parseNumber<int>(*this, column, text(column));
+}
+
+long long CsvRow::toInt64(size_t column) const {
+    return parseNumber<long long>(*this, column, text(column));
+}
+
+double CsvRow::toDouble(size_t column) const {
+    return parseNumber<double>(*this, column, text(column));
+}
+
+void CsvRow::fail(size_t column, const std::string& reason) const {
+    throw CsvParseException(row_number, column + 1, reason);
+}
+
+bool CsvReader::next(CsvRow& row) {
+    while (cursor < end) {
+        const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', end - cursor));
+        const char* line_end = newline ? newline : end;
+        std::string_view line(cursor, line_end - cursor);
+        cursor = newline ? newline + 1 : end;
+        line_number++;
+
+        if (line.empty() || line == "\r") continue;
+        row.parse(line, line_number);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+
+// One CSV line split into views over the caller's buffer. Fields are only
+// copied when an entity takes ownership of them; numbers go through from_chars.
+class CsvRow {
+public:
+    static constexpr size_t MAX_FIELDS = 16;
+
+private:
+    std::string_view fields[MAX_FIELDS];
+    size_t count = 0;
+    size_t row_number = 0;
+
+public:
+    CsvRow() = default;
+    explicit CsvRow(std::string_view line, size_t row_number = 1) { parse(line, row_number); }
+
+    void parse(std::string_view line, size_t row_number);
+
+    size_t size() const { return count; }
+    size_t row() const { return row_number; }
+    bool has(size_t column) const { return column < count; }
+
+    std::string_view text(size_t column) const;
+    int toInt(size_t column) const;
+    long long toInt64(size_t column) const;
+    double toDouble(size_t column) const;
+    bool toFlag(size_t column) const { return text(column) == "1"; }
+
+    [[noreturn]] void fail(size_t column, const std::string& reason) const;
+};
+
+// Walks the lines of an in-memory file, skipping blank ones
+class CsvReader {
+private:
+    const char* cursor;
+    const char* end;
+    size_t line_number = 0;
+
+public:
+    CsvReader(const char* data, size_t size) : cursor(data), end(data + size) {}
+
+    bool next(CsvRow& row);
+    // Lines consumed so far, blank ones included
+    size_t lines() const { return line_number; }
+};
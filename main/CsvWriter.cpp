@@ -0,0 +1,39 @@
+#include "CsvWriter.h"
+#include <charconv>
+
+void CsvLineWriter::separate() {
+    if (!first) {
+        out += ',';
+    }
+    first = false;
+}
+
+CsvLineWriter& CsvLineWriter::text(std::string_view value) {
+    separate();
+    out.append(value.data(), value.size());
+    return *this;
+}
+
+CsvLineWriter& CsvLineWriter::integer(long long value) {
+    separate();
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+    return *this;
+}
+
+CsvLineWriter& CsvLineWriter::number(double value) {
+    separate();
+    char digits[32];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::general, 6);
+    out.append(digits, result.ptr);
+    return *this;
+}
+
+CsvLineWriter& CsvLineWriter::fixed(double value, int precision) {
+    separate();
+    char digits[352];   // room for DBL_MAX in fixed notation
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, std::chars_format::fixed, precision);
+    out.append(digits, result.ptr);
+    return *this;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+// Appends the fields of one CSV line to a caller-owned buffer. Numbers go
+// through to_chars and come out exactly as the old stringstream code printed them.
+class CsvLineWriter {
+private:
+    std::string& out;
+    bool first = true;
+
+    void separate();
+
+public:
+    explicit CsvLineWriter(std::string& out) : out(out) {}
+
+    CsvLineWriter& text(std::string_view value);
+    CsvLineWriter& integer(long long value);
+    // Default stream formatting: six significant digits, like %g
+    CsvLineWriter& number(double value);
+    CsvLineWriter& fixed(double value, int precision);
+    CsvLineWriter& flag(bool value) { return text(value ? "1" : "0"); }
+};
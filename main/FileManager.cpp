@@ -5,100 +5,861 @@
 #include <filesystem>
 #include <iomanip>
 #include <algorithm>
+#include <unordered_map>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <type_traits>
+#include <future>
+#include <iterator>
 #include "AirlineExceptions.h"
+#include "MappedFile.h"
+#include "CsvReader.h"
+#include "CsvWriter.h"
+#include "ThreadPool.h"
+#include "OrderedOutput.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// First row wins, matching the linear find_if lookups these reports used to do.
+template <typename T>
+std::unordered_map<int, const T*> indexById(const std::deque<T>& rows, int (T::*id_of)() const) {
+    std::unordered_map<int, const T*> index;
+    index.reserve(rows.size());
+    for (const auto& row : rows) {
+        index.emplace((row.*id_of)(), &row);
+    }
+    return index;
+}
+
+template <typename T>
+std::unordered_map<int, size_t> slotsById(const std::deque<T>& rows, int (T::*id_of)() const) {
+    std::unordered_map<int, size_t> slots;
+    slots.reserve(rows.size());
+    for (size_t i = 0; i < rows.size(); ++i) {
+        slots.emplace((rows[i].*id_of)(), i);
+    }
+    return slots;
+}
+
+// Journal rows carry the full new state of a record, so replaying one twice is harmless
+template <typename T>
+void upsertById(std::deque<T>& rows, std::unordered_map<int, size_t>& slots, T row, int (T::*id_of)() const) {
+    int id = (row.*id_of)();
+    auto it = slots.find(id);
+    if (it != slots.end()) {
+        rows[it->second] = std::move(row);
+    } else {
+        slots.emplace(id, rows.size());
+        rows.push_back(std::move(row));
+    }
+}
+
+// Pushes a closed file's contents to stable storage
+void syncFile(const std::string& path) {
+#ifdef _WIN32
+    int fd = _open(path.c_str(), _O_WRONLY | _O_BINARY);
+    bool synced = fd >= 0 && _commit(fd) == 0;
+    if (fd >= 0) _close(fd);
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    bool synced = fd >= 0 && ::fsync(fd) == 0;
+    if (fd >= 0) ::close(fd);
+#endif
+    if (!synced) {
+        throw FileOperationException("fsync " + path);
+    }
+}
+
+// Makes renames inside a directory durable. Windows has no equivalent.
+void syncDirectory(const std::string& path) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY | O_DIRECTORY);
+    bool synced = fd >= 0 && ::fsync(fd) == 0;
+    if (fd >= 0) ::close(fd);
+    if (!synced) {
+        throw FileOperationException("fsync " + path);
+    }
+#else
+    (void)path;
+#endif
+}
+
+void syncStream(std::FILE* stream) {
+#ifdef _WIN32
+    bool synced = _commit(_fileno(stream)) == 0;
+#else
+    bool synced = ::fsync(fileno(stream)) == 0;
+#endif
+    if (!synced) {
+        throw FileOperationException("fsync journal");
+    }
+}
+
+// Tables smaller than this are parsed on the calling thread
+const size_t MIN_CHUNK_BYTES = 1 << 20;
+
+// Splits [0, size) into at most `parts` ranges, each ending just after a newline
+std::vector<std::pair<size_t, size_t>> splitLines(const char* data, size_t size, size_t parts) {
+    std::vector<std::pair<size_t, size_t>> ranges;
+    size_t begin = 0;
+    for (size_t i = 1; i < parts && begin < size; ++i) {
+        size_t target = std::max(begin, size / parts * i);
+        const void* newline = std::memchr(data + target, '\n', size - target);
+        size_t end = newline ? static_cast<const char*>(newline) - data + 1 : size;
+        ranges.emplace_back(begin, end);
+        begin = end;
+    }
+    if (begin < size || ranges.empty()) {
+        ranges.emplace_back(begin, size);
+    }
+    return ranges;
+}
+
+// Rows parsed from one slice of a table. Row numbers in `errors` are relative
+// to the slice until the slices are merged.
+template <typename T>
+struct ParsedChunk {
+    std::vector<T> rows;
+    std::vector<CsvParseException> errors;
+    size_t lines = 0;
+};
+
+template <typename T>
+ParsedChunk<T> parseChunk(const char* data, size_t size, bool skip_invalid,
+                          T (*from_fields)(const CsvRow&)) {
+    ParsedChunk<T> chunk;
+    CsvReader reader(data, size);
+    CsvRow row;
+    while (reader.next(row)) {
+        try {
+            chunk.rows.push_back(from_fields(row));
+        } catch (const CsvParseException& e) {
+            chunk.errors.push_back(e);
+            if (!skip_invalid) {
+                break;
+            }
+        }
+    }
+    chunk.lines = reader.lines();
+    return chunk;
+}
+
+// Parses newline-aligned slices on the pool and concatenates them in file
+// order, so the result matches a single sequential pass.
+template <typename T>
+std::deque<T> parseTable(const MappedFile& file, ThreadPool* pool, bool skip_invalid, const char* what,
+                         T (*from_fields)(const CsvRow&)) {
+    size_t parts = pool ? std::min(pool->size() * 2, file.size() / MIN_CHUNK_BYTES + 1) : 1;
+    auto ranges = splitLines(file.data(), file.size(), parts);
+
+    std::vector<ParsedChunk<T>> chunks;
+    if (ranges.size() == 1) {
+        chunks.push_back(parseChunk(file.data(), file.size(), skip_invalid, from_fields));
+    } else {
+        std::vector<std::future<ParsedChunk<T>>> pending;
+        for (const auto& range : ranges) {
+            pending.push_back(pool->submit([&file, range, skip_invalid, from_fields]() {
+                return parseChunk(file.data() + range.first, range.second - range.first,
+                                  skip_invalid, from_fields);
+            }));
+        }
+        // Every task reads the mapping, so let them all finish before anything can throw
+        for (auto& result : pending) {
+            result.wait();
+        }
+        for (auto& result : pending) {
+            chunks.push_back(result.get());
+        }
+    }
+
+    std::deque<T> rows;
+    size_t line_base = 0;
+    for (auto& chunk : chunks) {
+        for (const auto& error : chunk.errors) {
+            CsvParseException located(line_base + error.getRow(), error.getColumn(), error.getReason());
+            if (!skip_invalid) {
+                throw located;
+            }
+            std::cerr << "Warning: Skipping invalid " << what << " data: " << located.what() << std::endl;
+        }
+        std::move(chunk.rows.begin(), chunk.rows.end(), std::back_inserter(rows));
+        line_base += chunk.lines;
+    }
+    return rows;
+}
+
+// Binary snapshot layout. Every section starts on an 8-byte boundary; bump
+// SNAPSHOT_VERSION whenever a record changes shape.
+const char SNAPSHOT_MAGIC[8] = {'A', 'R', 'S', 'N', 'A', 'P', '\r', '\n'};
+const uint32_t SNAPSHOT_VERSION = 3;
+// Version 1 had no flight capacity; its capacity slot was always zero padding
+const uint32_t SNAPSHOT_VERSION_NO_CAPACITY = 1;
+// Version 2 added the capacity; neither stored the id sequences
+const uint32_t SNAPSHOT_VERSION_NO_SEQUENCES = 2;
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint64_t passenger_count;
+    uint64_t flight_count;
+    uint64_t reservation_count;
+    uint64_t passengers_offset;
+    uint64_t flights_offset;
+    uint64_t reservations_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+    int64_t next_passenger_id;
+    int64_t next_flight_id;
+    int64_t next_reservation_id;
+};
+
+// Header size of the versions before the id sequences were added
+const size_t SEQUENCELESS_HEADER_SIZE = offsetof(SnapshotHeader, next_passenger_id);
+
+struct StringRef {
+    uint64_t offset;
+    uint64_t length;
+};
+
+struct PassengerRecord {
+    int32_t passenger_id;
+    uint32_t is_deleted;
+    double wallet_balance;
+    StringRef name;
+    StringRef passport_number;
+    StringRef national_id;
+    StringRef nationality;
+};
+
+struct FlightRecord {
+    int32_t flight_id;
+    int32_t available_seats;
+    int64_t departure_time;
+    double ticket_price;
+    uint32_t is_deleted;
+    int32_t capacity;
+    StringRef flight_number;
+    StringRef origin;
+    StringRef destination;
+};
+
+struct ReservationRecord {
+    int32_t reservation_id;
+    int32_t passenger_id;
+    int32_t flight_id;
+    uint32_t flags;
+    double amount_paid;
+    int64_t reservation_time;
+    int64_t flight_departure_time;
+};
+
+const uint32_t RESERVATION_CANCELLED = 1;
+const uint32_t RESERVATION_DELETED = 2;
+
+static_assert(std::is_trivially_copyable<PassengerRecord>::value &&
+              std::is_trivially_copyable<FlightRecord>::value &&
+              std::is_trivially_copyable<ReservationRecord>::value,
+              "snapshot records are copied as raw bytes");
+
+uint64_t alignTo8(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+class StringPool {
+private:
+    std::string bytes;
+
+public:
+    StringRef add(const std::string& value) {
+        StringRef ref{bytes.size(), value.size()};
+        bytes += value;
+        return ref;
+    }
+    const std::string& data() const { return bytes; }
+};
+
+// Bounds-checked reader over the mapped snapshot
+class SnapshotReader {
+private:
+    const MappedFile& file;
+    const char* strings = nullptr;
+    uint64_t strings_size = 0;
+
+public:
+    explicit SnapshotReader(const MappedFile& file) : file(file) {}
+
+    void fail(const std::string& reason) const {
+        throw FileOperationException("invalid binary snapshot (" + reason + ")");
+    }
+
+    template <typename Record>
+    Record record(uint64_t section_offset, uint64_t index) const {
+        Record record;
+        std::memcpy(&record, file.data() + section_offset + index * sizeof(Record), sizeof(Record));
+        return record;
+    }
+
+    void checkSection(uint64_t offset, uint64_t count, uint64_t record_size, const char* name) const {
+        if (offset > file.size() || count > (file.size() - offset) / record_size) {
+            fail(std::string(name) + " section out of range");
+        }
+    }
+
+    void setStrings(uint64_t offset, uint64_t size) {
+        if (offset > file.size() || size > file.size() - offset) {
+            fail("string pool out of range");
+        }
+        strings = file.data() + offset;
+        strings_size = size;
+    }
+
+    std::string text(const StringRef& ref) const {
+        if (ref.offset > strings_size || ref.length > strings_size - ref.offset) {
+            fail("string out of range");
+        }
+        return std::string(strings + ref.offset, ref.length);
+    }
+};
+
+}
 
 void FileManager::ensureDirectoryExists() {
     std::filesystem::create_directories("data");
 }
 
-std::vector<Passenger> FileManager::loadPassengers() {
-    std::vector<Passenger> passengers;
+template <typename T>
+void FileManager::writeTable(const std::string& file_name, const std::deque<T>& rows, size_t append_from) {
+    std::ofstream file = openStaged(file_name);
+
+    // Rows were validated when they were inserted; here they are only serialized
+    auto flush = [&]() {
+        file.write(write_buffer.data(), write_buffer.size());
+        write_buffer.clear();
+        if (file.fail()) {
+            throw AirlineException("Error writing " + file_name);
+        }
+    };
+    write_buffer.clear();
+    write_buffer.reserve(WRITE_BLOCK_BYTES + 1024);
+    for (size_t i = append_from; i < rows.size(); ++i) {
+        rows[i].appendCSV(write_buffer);
+        write_buffer += '\n';
+        if (write_buffer.size() >= WRITE_BLOCK_BYTES) {
+            flush();
+        }
+    }
+    flush();
+    finishStaged(file, file_name, append_from > 0);
+}
+
+template <typename T>
+TableImage FileManager::imageOf(const std::string& file_name, const std::deque<T>& rows, size_t append_from) {
+    TableImage image{file_name, std::string(), append_from > 0};
+    for (size_t i = append_from; i < rows.size(); ++i) {
+        rows[i].appendCSV(image.bytes);
+        image.bytes += '\n';
+    }
+    return image;
+}
+
+std::ofstream FileManager::openStaged(const std::string& file_name) {
     ensureDirectoryExists();
-    
-    std::ifstream file("data/" + PASSENGERS_FILE);
+    std::ofstream file("data/" + file_name + ".tmp", std::ios::trunc);
     if (!file.is_open()) {
-        // Create new file if it doesn't exist
-        std::ofstream newFile("data/" + PASSENGERS_FILE);
-        if (!newFile.is_open()) {
-            throw AirlineException("Could not create passengers file");
-        }
-        newFile.close();
-        return passengers;
+        throw AirlineException("Could not open " + file_name + " for writing");
     }
+    return file;
+}
 
-    std::string line;
-    while (std::getline(file, line)) {
+void FileManager::finishStaged(std::ofstream& file, const std::string& file_name, bool append) {
+    std::string live_path = "data/" + file_name;
+    std::string staged_path = live_path + ".tmp";
+    file.close();
+    if (file.fail()) {
+        throw AirlineException("Error writing " + file_name);
+    }
+    if (durability != Durability::None) {
+        syncFile(staged_path);
+    }
+
+    uintmax_t base_size = append && std::filesystem::exists(live_path) ? std::filesystem::file_size(live_path) : 0;
+    staged_tables.erase(std::remove_if(staged_tables.begin(), staged_tables.end(),
+                                       [&](const StagedTable& t) { return t.file_name == file_name; }),
+                        staged_tables.end());
+    staged_tables.push_back({file_name, append, base_size});
+    if (!commit_open) {
+        commitTables();
+    }
+}
+
+FileManager::~FileManager() {
+    if (journal_file) {
         try {
-            if (!line.empty()) {
-                passengers.push_back(Passenger::fromCSV(line));
+            if (unsynced_journal_records > 0 && durability != Durability::None) {
+                syncStream(journal_file);
             }
         } catch (const std::exception& e) {
-            std::cerr << "Warning: Skipping invalid passenger data: " << e.what() << std::endl;
+            std::cerr << "Warning: " << e.what() << std::endl;
         }
+        std::fclose(journal_file);
     }
-    
-    file.close();
-    return passengers;
 }
 
-std::vector<Flight> FileManager::loadFlights() {
-    std::vector<Flight> flights;
+void FileManager::beginCommit() {
+    abortCommit();
+    commit_open = true;
+}
+
+void FileManager::abortCommit() {
+    for (const auto& table : staged_tables) {
+        std::error_code ignored;
+        std::filesystem::remove("data/" + table.file_name + ".tmp", ignored);
+    }
+    staged_tables.clear();
+    commit_open = false;
+}
+
+void FileManager::commitTables() {
+    std::vector<StagedTable> tables;
+    tables.swap(staged_tables);
+    commit_open = false;
+    if (tables.empty()) {
+        return;
+    }
+
+    // The intent file is the commit point: once it is in place, recovery rolls the group forward
+    bool sync = durability != Durability::None;
+    std::string intent_path = "data/" + COMMIT_FILE;
+    std::ofstream intent(intent_path + ".tmp", std::ios::trunc);
+    for (const auto& table : tables) {
+        intent << (table.append ? "append " : "replace ") << table.file_name << ' ' << table.base_size << '\n';
+    }
+    intent.close();
+    if (intent.fail()) {
+        throw FileOperationException("write " + intent_path);
+    }
+    if (sync) {
+        syncFile(intent_path + ".tmp");
+    }
+    std::filesystem::rename(intent_path + ".tmp", intent_path);
+    if (sync) {
+        syncDirectory("data");
+    }
+
+    applyCommit(tables);
+    if (sync) {
+        syncDirectory("data");
+    }
+    std::filesystem::remove(intent_path);
+}
+
+void FileManager::applyCommit(const std::vector<StagedTable>& tables) {
+    for (const auto& table : tables) {
+        std::string live_path = "data/" + table.file_name;
+        std::string staged_path = live_path + ".tmp";
+        if (!std::filesystem::exists(staged_path)) {
+            continue;   // applied before the crash
+        }
+        if (!table.append) {
+            std::filesystem::rename(staged_path, live_path);
+            continue;
+        }
+
+        // Cut back any rows a previous attempt managed to append, then append them again
+        if (std::filesystem::exists(live_path) && std::filesystem::file_size(live_path) > table.base_size) {
+            std::filesystem::resize_file(live_path, table.base_size);
+        }
+        {
+            std::ifstream staged(staged_path, std::ios::binary);
+            std::ofstream live(live_path, std::ios::binary | std::ios::app);
+            live << staged.rdbuf();
+            live.close();
+            if (!staged.is_open() || live.fail()) {
+                throw FileOperationException("append " + live_path);
+            }
+        }
+        if (durability != Durability::None) {
+            syncFile(live_path);
+        }
+        std::filesystem::remove(staged_path);
+    }
+}
+
+void FileManager::recoverCommit() {
     ensureDirectoryExists();
-    
-    std::ifstream file("data/" + FLIGHTS_FILE);
-    if (!file.is_open()) {
+    std::string intent_path = "data/" + COMMIT_FILE;
+    if (std::filesystem::exists(intent_path)) {
+        std::vector<StagedTable> tables;
+        std::ifstream intent(intent_path);
+        std::string mode;
+        StagedTable table;
+        while (intent >> mode >> table.file_name >> table.base_size) {
+            if (mode != "append" && mode != "replace") {
+                throw FileOperationException("invalid commit intent " + intent_path);
+            }
+            table.append = mode == "append";
+            tables.push_back(table);
+        }
+        intent.close();
+        applyCommit(tables);
+        if (durability != Durability::None) {
+            syncDirectory("data");
+        }
+        std::filesystem::remove(intent_path);
+    }
+
+    // Whatever is still staged never reached its commit point
+    for (const auto& entry : std::filesystem::directory_iterator("data")) {
+        if (entry.path().extension() == ".tmp") {
+            std::filesystem::remove(entry.path());
+        }
+    }
+}
+
+bool FileManager::openTable(const std::string& file_name, std::unique_ptr<MappedFile>& mapped) {
+    ensureDirectoryExists();
+    std::string path = "data/" + file_name;
+    if (!std::filesystem::exists(path)) {
         // Create new file if it doesn't exist
-        std::ofstream newFile("data/" + FLIGHTS_FILE);
+        std::ofstream newFile(path);
         if (!newFile.is_open()) {
-            throw AirlineException("Could not create flights file");
+            throw AirlineException("Could not create " + file_name);
         }
-        newFile.close();
-        return flights;
+        return false;
+    }
+    mapped = std::make_unique<MappedFile>(path);
+    return true;
+}
+
+std::deque<Passenger> FileManager::loadPassengers() {
+    std::unique_ptr<MappedFile> file;
+    if (!openTable(PASSENGERS_FILE, file)) {
+        return {};
     }
+    return parseTable(*file, pool, true, "passenger", &Passenger::fromFields);
+}
 
+std::deque<Flight> FileManager::loadFlights() {
+    std::unique_ptr<MappedFile> file;
+    if (!openTable(FLIGHTS_FILE, file)) {
+        return {};
+    }
     try {
-        std::string line;
-        while (std::getline(file, line)) {
-            if (!line.empty()) {
-                flights.push_back(Flight::fromCSV(line));
-            }
-        }
+        return parseTable(*file, pool, false, "flight", &Flight::fromFields);
     } catch (const std::exception& e) {
         throw AirlineException("Error reading flights file: " + std::string(e.what()));
     }
-    
-    file.close();
-    return flights;
 }
 
-std::vector<Reservation> FileManager::loadReservations() {
-    std::vector<Reservation> reservations;
+std::deque<Reservation> FileManager::loadReservations() {
+    std::unique_ptr<MappedFile> file;
+    if (!openTable(RESERVATIONS_FILE, file)) {
+        return {};
+    }
+    try {
+        return parseTable(*file, pool, false, "reservation", &Reservation::fromFields);
+    } catch (const std::exception& e) {
+        throw AirlineException("Error reading reservations file: " + std::string(e.what()));
+    }
+}
+
+void FileManager::forEachRow(const std::string& path, const std::function<void(const CsvRow&)>& visit) {
+    MappedFile file(path);
+    CsvReader reader(file.data(), file.size());
+    CsvRow row;
+    while (reader.next(row)) {
+        visit(row);
+    }
+}
+
+void FileManager::loadTables(std::deque<Passenger>& passengers,
+                             std::deque<Flight>& flights,
+                             std::deque<Reservation>& reservations) {
     ensureDirectoryExists();
-    
-    std::ifstream file("data/" + RESERVATIONS_FILE);
+    // The three files are independent; each loader fans its own slices out to the pool
+    auto passengers_loaded = std::async(std::launch::async, [this]() { return loadPassengers(); });
+    auto flights_loaded = std::async(std::launch::async, [this]() { return loadFlights(); });
+    reservations = loadReservations();
+    flights = flights_loaded.get();
+    passengers = passengers_loaded.get();
+}
+
+bool FileManager::hasBinarySnapshot() {
+    return std::filesystem::exists("data/" + SNAPSHOT_FILE);
+}
+
+void FileManager::saveBinarySnapshot(const std::deque<Passenger>& passengers,
+                                     const std::deque<Flight>& flights,
+                                     const std::deque<Reservation>& reservations,
+                                     const IdSequences& sequences) {
+    saveBinaryImage(binarySnapshotImage(passengers, flights, reservations, sequences));
+}
+
+std::string FileManager::binarySnapshotImage(const std::deque<Passenger>& passengers,
+                                             const std::deque<Flight>& flights,
+                                             const std::deque<Reservation>& reservations,
+                                             const IdSequences& sequences) {
+    StringPool pool;
+    std::vector<PassengerRecord> passenger_records;
+    passenger_records.reserve(passengers.size());
+    for (const auto& p : passengers) {
+        passenger_records.push_back({p.getPassengerId(), p.isDeleted() ? 1u : 0u, p.getWalletBalance(),
+                                     pool.add(p.getName()), pool.add(p.getPassportNumber()),
+                                     pool.add(p.getNationalId()), pool.add(p.getNationality())});
+    }
+
+    std::vector<FlightRecord> flight_records;
+    flight_records.reserve(flights.size());
+    for (const auto& f : flights) {
+        flight_records.push_back({f.getFlightId(), f.getAvailableSeats(),
+                                  static_cast<int64_t>(f.getDepartureTime()), f.getTicketPrice(),
+                                  f.isDeleted() ? 1u : 0u, f.getCapacity(), pool.add(f.getFlightNumber()),
+                                  pool.add(f.getOrigin()), pool.add(f.getDestination())});
+    }
+
+    std::vector<ReservationRecord> reservation_records;
+    reservation_records.reserve(reservations.size());
+    for (const auto& r : reservations) {
+        uint32_t flags = (r.isCancelled() ? RESERVATION_CANCELLED : 0u) | (r.isDeleted() ? RESERVATION_DELETED : 0u);
+        reservation_records.push_back({r.getReservationId(), r.getPassengerId(), r.getFlightId(), flags,
+                                       r.getAmountPaid(), static_cast<int64_t>(r.getReservationTime()),
+                                       static_cast<int64_t>(r.getFlightDepartureTime())});
+    }
+
+    SnapshotHeader header = {};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.header_size = sizeof(SnapshotHeader);
+    header.passenger_count = passenger_records.size();
+    header.flight_count = flight_records.size();
+    header.reservation_count = reservation_records.size();
+    header.passengers_offset = alignTo8(sizeof(SnapshotHeader));
+    header.flights_offset = alignTo8(header.passengers_offset + passenger_records.size() * sizeof(PassengerRecord));
+    header.reservations_offset = alignTo8(header.flights_offset + flight_records.size() * sizeof(FlightRecord));
+    header.strings_offset = alignTo8(header.reservations_offset + reservation_records.size() * sizeof(ReservationRecord));
+    header.strings_size = pool.data().size();
+    header.next_passenger_id = sequences.passenger;
+    header.next_flight_id = sequences.flight;
+    header.next_reservation_id = sequences.reservation;
+
+    std::string image(header.strings_offset + header.strings_size, '\0');
+    std::memcpy(&image[0], &header, sizeof(header));
+    if (!passenger_records.empty()) {
+        std::memcpy(&image[header.passengers_offset], passenger_records.data(), passenger_records.size() * sizeof(PassengerRecord));
+    }
+    if (!flight_records.empty()) {
+        std::memcpy(&image[header.flights_offset], flight_records.data(), flight_records.size() * sizeof(FlightRecord));
+    }
+    if (!reservation_records.empty()) {
+        std::memcpy(&image[header.reservations_offset], reservation_records.data(), reservation_records.size() * sizeof(ReservationRecord));
+    }
+    std::memcpy(&image[header.strings_offset], pool.data().data(), pool.data().size());
+    return image;
+}
+
+void FileManager::saveBinaryImage(const std::string& image) {
+    // Write beside the old snapshot and swap it in, so a failed write never leaves half a file
+    ensureDirectoryExists();
+    std::string path = "data/" + SNAPSHOT_FILE;
+    std::ofstream file(path + ".tmp", std::ios::binary | std::ios::trunc);
     if (!file.is_open()) {
-        // Create new file if it doesn't exist
-        std::ofstream newFile("data/" + RESERVATIONS_FILE);
-        if (!newFile.is_open()) {
-            throw AirlineException("Could not create reservations file");
-        }
-        newFile.close();
-        return reservations;
+        throw AirlineException("Could not open binary snapshot for writing");
+    }
+    file.write(image.data(), image.size());
+    file.close();
+    if (file.fail()) {
+        throw AirlineException("Error writing binary snapshot");
+    }
+    if (durability != Durability::None) {
+        syncFile(path + ".tmp");
+    }
+    std::filesystem::rename(path + ".tmp", path);
+    if (durability != Durability::None) {
+        syncDirectory("data");
+    }
+}
+
+IdSequences FileManager::loadBinarySnapshot(std::deque<Passenger>& passengers,
+                                            std::deque<Flight>& flights,
+                                            std::deque<Reservation>& reservations) {
+    MappedFile file("data/" + SNAPSHOT_FILE);
+    SnapshotReader reader(file);
+
+    // Older headers are shorter; the fields they lack stay zero
+    SnapshotHeader header = {};
+    if (file.size() < SEQUENCELESS_HEADER_SIZE) {
+        reader.fail("truncated header");
+    }
+    std::memcpy(&header, file.data(), std::min(file.size(), sizeof(header)));
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0) {
+        reader.fail("bad magic");
+    }
+    bool has_sequences = header.version == SNAPSHOT_VERSION;
+    bool has_capacity = has_sequences || header.version == SNAPSHOT_VERSION_NO_SEQUENCES;
+    bool known_version = has_capacity || header.version == SNAPSHOT_VERSION_NO_CAPACITY;
+    if (!known_version || header.header_size != (has_sequences ? sizeof(SnapshotHeader) : SEQUENCELESS_HEADER_SIZE)) {
+        reader.fail("unsupported version " + std::to_string(header.version));
     }
+    if (!has_sequences) {
+        std::memset(&header.next_passenger_id, 0, sizeof(SnapshotHeader) - SEQUENCELESS_HEADER_SIZE);
+    }
+    reader.checkSection(header.passengers_offset, header.passenger_count, sizeof(PassengerRecord), "passenger");
+    reader.checkSection(header.flights_offset, header.flight_count, sizeof(FlightRecord), "flight");
+    reader.checkSection(header.reservations_offset, header.reservation_count, sizeof(ReservationRecord), "reservation");
+    reader.setStrings(header.strings_offset, header.strings_size);
+
+    passengers.clear();
+    for (uint64_t i = 0; i < header.passenger_count; ++i) {
+        auto r = reader.record<PassengerRecord>(header.passengers_offset, i);
+        passengers.push_back(Passenger::restore(r.passenger_id, reader.text(r.name), reader.text(r.passport_number),
+                                                reader.text(r.national_id), reader.text(r.nationality),
+                                                r.wallet_balance, r.is_deleted != 0));
+    }
+
+    flights.clear();
+    for (uint64_t i = 0; i < header.flight_count; ++i) {
+        auto r = reader.record<FlightRecord>(header.flights_offset, i);
+        flights.push_back(Flight::restore(r.flight_id, reader.text(r.flight_number), reader.text(r.origin),
+                                          reader.text(r.destination), static_cast<time_t>(r.departure_time),
+                                          r.available_seats, r.ticket_price, r.is_deleted != 0,
+                                          has_capacity ? r.capacity : Flight::UNKNOWN_CAPACITY));
+    }
+
+    reservations.clear();
+    for (uint64_t i = 0; i < header.reservation_count; ++i) {
+        auto r = reader.record<ReservationRecord>(header.reservations_offset, i);
+        reservations.push_back(Reservation::restore(r.reservation_id, r.passenger_id, r.flight_id, r.amount_paid,
+                                                    static_cast<time_t>(r.reservation_time),
+                                                    static_cast<time_t>(r.flight_departure_time),
+                                                    (r.flags & RESERVATION_CANCELLED) != 0,
+                                                    (r.flags & RESERVATION_DELETED) != 0));
+    }
+
+    // Zero means the snapshot predates stored sequences; the loaded ids still bound them
+    IdSequences sequences;
+    sequences.passenger = std::max<int64_t>(header.next_passenger_id, 1);
+    sequences.flight = std::max<int64_t>(header.next_flight_id, 1);
+    sequences.reservation = std::max<int64_t>(header.next_reservation_id, 1);
+    return sequences;
+}
 
+void FileManager::convertCsvToBinary() {
+    recoverCommit();
+    std::deque<Passenger> passengers;
+    std::deque<Flight> flights;
+    std::deque<Reservation> reservations;
+    loadTables(passengers, flights, reservations);
+    saveBinarySnapshot(passengers, flights, reservations, loadSequences());
+}
+
+void FileManager::convertBinaryToCsv() {
+    std::deque<Passenger> passengers;
+    std::deque<Flight> flights;
+    std::deque<Reservation> reservations;
+    IdSequences sequences = loadBinarySnapshot(passengers, flights, reservations);
+    beginCommit();
     try {
-        std::string line;
-        while (std::getline(file, line)) {
-            if (!line.empty()) {
-                reservations.push_back(Reservation::fromCSV(line));
+        savePassengers(passengers);
+        saveFlights(flights);
+        saveReservations(reservations);
+        saveSequences(sequences);
+        commitTables();
+    } catch (...) {
+        abortCommit();
+        throw;
+    }
+}
+
+void FileManager::appendJournal(const std::string& record) {
+    if (!journal_file) {
+        ensureDirectoryExists();
+        journal_file = std::fopen(("data/" + JOURNAL_FILE).c_str(), "a");
+        if (!journal_file) {
+            throw AirlineException("Could not open journal file for writing");
+        }
+    }
+
+    if (std::fwrite(record.data(), 1, record.size(), journal_file) != record.size() ||
+        std::fflush(journal_file) != 0) {
+        throw AirlineException("Error writing journal record");
+    }
+    ++unsynced_journal_records;
+    if (durability == Durability::Fsync ||
+        (durability == Durability::Group && unsynced_journal_records >= JOURNAL_GROUP_RECORDS)) {
+        syncJournal();
+    }
+}
+
+void FileManager::syncJournal() {
+    syncStream(journal_file);
+    unsynced_journal_records = 0;
+}
+
+size_t FileManager::replayJournal(std::deque<Passenger>& passengers,
+                                  std::deque<Flight>& flights,
+                                  std::deque<Reservation>& reservations) {
+    std::ifstream file("data/" + JOURNAL_FILE);
+    if (!file.is_open()) {
+        return 0;
+    }
+
+    auto passenger_slots = slotsById(passengers, &Passenger::getPassengerId);
+    auto flight_slots = slotsById(flights, &Flight::getFlightId);
+    auto reservation_slots = slotsById(reservations, &Reservation::getReservationId);
+
+    // Rows only take effect once their record's commit line is read; a torn tail is dropped
+    std::vector<std::string> pending;
+    size_t records = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line == "C") {
+            for (const auto& row : pending) {
+                std::string csv = row.substr(2);
+                switch (row[0]) {
+                    case 'P': upsertById(passengers, passenger_slots, Passenger::fromCSV(csv), &Passenger::getPassengerId); break;
+                    case 'F': upsertById(flights, flight_slots, Flight::fromCSV(csv), &Flight::getFlightId); break;
+                    case 'R': upsertById(reservations, reservation_slots, Reservation::fromCSV(csv), &Reservation::getReservationId); break;
+                }
             }
+            pending.clear();
+            records++;
+        } else if (line.size() > 2 && line[1] == ',' &&
+                   (line[0] == 'P' || line[0] == 'F' || line[0] == 'R')) {
+            pending.push_back(line);
+        } else if (!line.empty()) {
+            throw AirlineException("Corrupt journal record: " + line);
         }
-    } catch (const std::exception& e) {
-        throw AirlineException("Error reading reservations file: " + std::string(e.what()));
     }
-    
-    file.close();
-    return reservations;
+
+    if (!pending.empty()) {
+        std::cerr << "Warning: Discarding incomplete journal record" << std::endl;
+    }
+    return records;
+}
+
+void FileManager::clearJournal() {
+    if (journal_file) {
+        std::fclose(journal_file);
+        journal_file = nullptr;
+    }
+    unsynced_journal_records = 0;
+    ensureDirectoryExists();
+    std::ofstream file("data/" + JOURNAL_FILE, std::ios::trunc);
+    if (!file.is_open()) {
+        throw AirlineException("Could not reset journal file");
+    }
 }
 
 void FileManager::validatePassengerData(const Passenger& passenger) {
@@ -120,7 +881,8 @@ void FileManager::validateFlightData(const Flight& flight) {
     if (flight.getOrigin().empty() || flight.getDestination().empty()) {
         throw InvalidInputException("origin/destination");
     }
-    if (flight.getAvailableSeats() < 0) {
+    if (flight.getAvailableSeats() < 0 ||
+        (flight.hasCapacity() && flight.getAvailableSeats() > flight.getCapacity())) {
         throw InvalidInputException("available seats");
     }
     if (flight.getTicketPrice() <= 0) {
@@ -140,73 +902,65 @@ void FileManager::validateReservationData(const Reservation& reservation) {
     }
 }
 
-void FileManager::savePassengers(const std::vector<Passenger>& passengers) {
-    ensureDirectoryExists();
-    std::ofstream file("data/" + PASSENGERS_FILE);
-    if (!file.is_open()) {
-        throw AirlineException("Could not open passengers file for writing");
-    }
-    
-    for (const auto& passenger : passengers) {
-        try {
-            validatePassengerData(passenger);
-            file << passenger.toCSV() << std::endl;
-            if (file.fail()) {
-                throw AirlineException("Error writing passenger data");
-            }
-        } catch (const std::exception& e) {
-            file.close();
-            throw AirlineException("Failed to save passenger: " + std::string(e.what()));
-        }
-    }
-    
-    file.close();
+TableImage FileManager::passengersImage(const std::deque<Passenger>& passengers, size_t append_from) {
+    return imageOf(PASSENGERS_FILE, passengers, append_from);
 }
 
-void FileManager::saveFlights(const std::vector<Flight>& flights) {
-    ensureDirectoryExists();
-    std::ofstream file("data/" + FLIGHTS_FILE);
-    if (!file.is_open()) {
-        throw AirlineException("Could not open flights file for writing");
-    }
-    
-    for (const auto& flight : flights) {
-        try {
-            validateFlightData(flight);
-            file << flight.toCSV() << std::endl;
-            if (file.fail()) {
-                throw AirlineException("Error writing flight data");
-            }
-        } catch (const std::exception& e) {
-            file.close();
-            throw AirlineException("Failed to save flight: " + std::string(e.what()));
-        }
-    }
-    
-    file.close();
+TableImage FileManager::flightsImage(const std::deque<Flight>& flights, size_t append_from) {
+    return imageOf(FLIGHTS_FILE, flights, append_from);
 }
 
-void FileManager::saveReservations(const std::vector<Reservation>& reservations) {
-    ensureDirectoryExists();
-    std::ofstream file("data/" + RESERVATIONS_FILE);
-    if (!file.is_open()) {
-        throw AirlineException("Could not open reservations file for writing");
-    }
-    
-    for (const auto& reservation : reservations) {
-        try {
-            validateReservationData(reservation);
-            file << reservation.toCSV() << std::endl;
-            if (file.fail()) {
-                throw AirlineException("Error writing reservation data");
-            }
-        } catch (const std::exception& e) {
-            file.close();
-            throw AirlineException("Failed to save reservation: " + std::string(e.what()));
-        }
+TableImage FileManager::reservationsImage(const std::deque<Reservation>& reservations, size_t append_from) {
+    return imageOf(RESERVATIONS_FILE, reservations, append_from);
+}
+
+TableImage FileManager::sequencesImage(const IdSequences& sequences) {
+    TableImage image{SEQUENCES_FILE, std::string(), false};
+    CsvLineWriter(image.bytes).text("passenger").integer(sequences.passenger);
+    image.bytes += '\n';
+    CsvLineWriter(image.bytes).text("flight").integer(sequences.flight);
+    image.bytes += '\n';
+    CsvLineWriter(image.bytes).text("reservation").integer(sequences.reservation);
+    image.bytes += '\n';
+    return image;
+}
+
+IdSequences FileManager::loadSequences() {
+    IdSequences sequences;
+    std::ifstream file("data/" + SEQUENCES_FILE);
+    std::string line;
+    size_t row_number = 0;
+    while (std::getline(file, line)) {
+        CsvRow row(line, ++row_number);
+        if (row.size() < 2) continue;
+        // Unknown names are skipped so newer files still load
+        if (row.text(0) == "passenger") sequences.passenger = row.toInt(1);
+        else if (row.text(0) == "flight") sequences.flight = row.toInt(1);
+        else if (row.text(0) == "reservation") sequences.reservation = row.toInt(1);
     }
-    
-    file.close();
+    return sequences;
+}
+
+void FileManager::saveSequences(const IdSequences& sequences) {
+    saveTableImage(sequencesImage(sequences));
+}
+
+void FileManager::saveTableImage(const TableImage& image) {
+    std::ofstream file = openStaged(image.file_name);
+    file.write(image.bytes.data(), image.bytes.size());
+    finishStaged(file, image.file_name, image.append);
+}
+
+void FileManager::savePassengers(const std::deque<Passenger>& passengers, size_t append_from) {
+    writeTable(PASSENGERS_FILE, passengers, append_from);
+}
+
+void FileManager::saveFlights(const std::deque<Flight>& flights, size_t append_from) {
+    writeTable(FLIGHTS_FILE, flights, append_from);
+}
+
+void FileManager::saveReservations(const std::deque<Reservation>& reservations, size_t append_from) {
+    writeTable(RESERVATIONS_FILE, reservations, append_from);
 }
 
 void FileManager::generateReport(const std::string& filename, const std::string& content) {
@@ -220,7 +974,7 @@ void FileManager::generateReport(const std::string& filename, const std::string&
 }
 
 void FileManager::generatePassengerReport(const std::string& filename, const Passenger& passenger, 
-                                        const std::vector<Reservation>& reservations) {
+                                        const std::deque<Reservation>& reservations) {
     std::ofstream file(filename);
     if (!file.is_open()) {
         throw AirlineException("Could not create passenger report file");
@@ -253,8 +1007,8 @@ void FileManager::generatePassengerReport(const std::string& filename, const Pas
 }
 
 void FileManager::generateFlightReport(const std::string& filename, const Flight& flight, 
-                                     const std::vector<Reservation>& reservations,
-                                     const std::vector<Passenger>& passengers) {
+                                     const std::deque<Reservation>& reservations,
+                                     const std::deque<Passenger>& passengers) {
     std::ofstream file(filename);
     if (!file.is_open()) {
         throw AirlineException("Could not create flight report file");
@@ -269,15 +1023,16 @@ void FileManager::generateFlightReport(const std::string& filename, const Flight
              << "From: " << flight.getOrigin() << " To: " << flight.getDestination() << "\n"
              << "Available Seats: " << flight.getAvailableSeats() << "\n\n"
              << "Passengers:\n";
+
+        auto passenger_by_id = indexById(passengers, &Passenger::getPassengerId);
          
         for (const auto& res : reservations) {
             if (res.getFlightId() == flight.getFlightId() && !res.isCancelled()) {
-                auto passenger = std::find_if(passengers.begin(), passengers.end(),
-                    [&](const Passenger& p) { return p.getPassengerId() == res.getPassengerId(); });
+                auto passenger = passenger_by_id.find(res.getPassengerId());
             
-                if (passenger != passengers.end()) {
-                    file << "Passenger: " << passenger->getName() 
-                         << " (ID: " << passenger->getPassengerId() << ")\n";
+                if (passenger != passenger_by_id.end()) {
+                    file << "Passenger: " << passenger->second->getName() 
+                         << " (ID: " << passenger->second->getPassengerId() << ")\n";
                 }
             }
         }
@@ -290,9 +1045,9 @@ void FileManager::generateFlightReport(const std::string& filename, const Flight
 }
 
 void FileManager::generateReservationsReport(const std::string& filename, 
-                                           const std::vector<Reservation>& reservations,
-                                           const std::vector<Passenger>& passengers,
-                                           const std::vector<Flight>& flights) {
+                                           const std::deque<Reservation>& reservations,
+                                           const std::deque<Passenger>& passengers,
+                                           const std::deque<Flight>& flights) {
     std::ofstream file(filename);
     if (!file.is_open()) {
         throw AirlineException("Could not create reservations report file");
@@ -302,22 +1057,25 @@ void FileManager::generateReservationsReport(const std::string& filename,
         file << std::fixed << std::setprecision(2);
         file << "Reservations Report\n"
              << "------------------\n\n";
+
+        auto passenger_by_id = indexById(passengers, &Passenger::getPassengerId);
+        auto flight_by_id = indexById(flights, &Flight::getFlightId);
          
-        for (const auto& res : reservations) {
-            auto passenger = std::find_if(passengers.begin(), passengers.end(),
-                [&](const Passenger& p) { return p.getPassengerId() == res.getPassengerId(); });
-            
-            auto flight = std::find_if(flights.begin(), flights.end(),
-                [&](const Flight& f) { return f.getFlightId() == res.getFlightId(); });
-            
-            if (passenger != passengers.end() && flight != flights.end()) {
-                file << "Reservation ID: " << res.getReservationId() << "\n"
-                     << "Passenger: " << passenger->getName() << "\n"
-                     << "Flight: " << flight->getFlightNumber() << "\n"
-                     << "Amount: " << res.getAmountPaid() << "\n"
-                     << "Status: " << (res.isCancelled() ? "Cancelled" : "Active") << "\n\n";
+        writeOrdered(file, pool, reservations.size(), [&](std::ostream& out, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                const Reservation& res = reservations[i];
+                auto passenger = passenger_by_id.find(res.getPassengerId());
+                auto flight = flight_by_id.find(res.getFlightId());
+
+                if (passenger != passenger_by_id.end() && flight != flight_by_id.end()) {
+                    out << "Reservation ID: " << res.getReservationId() << "\n"
+                        << "Passenger: " << passenger->second->getName() << "\n"
+                        << "Flight: " << flight->second->getFlightNumber() << "\n"
+                        << "Amount: " << res.getAmountPaid() << "\n"
+                        << "Status: " << (res.isCancelled() ? "Cancelled" : "Active") << "\n\n";
+                }
             }
-        }
+        });
         
         file.close();
     } catch (const std::exception& e) {
@@ -1,45 +1,180 @@
 #pragma once
 #include <string>
+#include <deque>
+#include <fstream>
+#include <memory>
 #include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <functional>
 #include "Passenger.h"
 #include "Flight.h"
 #include "Reservation.h"
 #include "AirlineExceptions.h"
+#include "MappedFile.h"
+#include "IdAllocator.h"
+
+class ThreadPool;
+class CsvRow;
+
+// How far a save goes to reach stable storage. Every mode swaps files in with
+// renames, so a crash never leaves a table half written.
+enum class Durability {
+    None,    // no fsync; the OS decides when data reaches the disk
+    Fsync,   // every snapshot commit and every journal record is fsynced
+    Group    // snapshot commits are fsynced; journal records are fsynced in batches
+};
+
+enum class SnapshotFormat {
+    Csv,     // passengers.csv, flights.csv and reservations.csv
+    Binary   // snapshot.bin, mmapped on load
+};
+
+// A table serialized ahead of time, so it can be written after the live rows
+// have moved on
+struct TableImage {
+    std::string file_name;
+    std::string bytes;
+    bool append = false;   // bytes are rows to add to the end of the file
+};
 
 class FileManager {
 private:
     const std::string PASSENGERS_FILE = "passengers.csv";
     const std::string FLIGHTS_FILE = "flights.csv";
     const std::string RESERVATIONS_FILE = "reservations.csv";
+    const std::string JOURNAL_FILE = "journal.log";
+    const std::string SNAPSHOT_FILE = "snapshot.bin";
+    const std::string SEQUENCES_FILE = "sequences.csv";
+
+    const std::string COMMIT_FILE = "commit.intent";
+    // Journal records that may be lost on power failure with Durability::Group
+    static constexpr size_t JOURNAL_GROUP_RECORDS = 32;
+
+    std::FILE* journal_file = nullptr;
+    size_t unsynced_journal_records = 0;
+    SnapshotFormat snapshot_format = SnapshotFormat::Csv;
+    Durability durability = Durability::Fsync;
+
+    // A table written to "<file>.tmp" and waiting for commitTables. Appended
+    // tables stage only their new rows, to be added after base_size bytes.
+    struct StagedTable {
+        std::string file_name;
+        bool append;
+        uintmax_t base_size;
+    };
+    std::vector<StagedTable> staged_tables;
+    bool commit_open = false;
+    ThreadPool* pool = nullptr;
+
+    // Saves serialize into this buffer and write it out in blocks of about WRITE_BLOCK_BYTES
+    static constexpr size_t WRITE_BLOCK_BYTES = 1 << 20;
+    std::string write_buffer;
 
     void ensureDirectoryExists();
+    template <typename T>
+    void writeTable(const std::string& file_name, const std::deque<T>& rows, size_t append_from);
+    template <typename T>
+    TableImage imageOf(const std::string& file_name, const std::deque<T>& rows, size_t append_from);
+    // Staged writes go to "<file>.tmp"; finishing one commits it unless a group is open
+    std::ofstream openStaged(const std::string& file_name);
+    void finishStaged(std::ofstream& file, const std::string& file_name, bool append);
+    // Maps an existing table file, or creates it empty and returns false
+    bool openTable(const std::string& file_name, std::unique_ptr<MappedFile>& mapped);
+    // Moves staged files into place; safe to repeat after a crash part way through
+    void applyCommit(const std::vector<StagedTable>& tables);
+    void syncJournal();
 
 public:
+    FileManager() = default;
+    ~FileManager();
+    FileManager(const FileManager&) = delete;
+    FileManager& operator=(const FileManager&) = delete;
+
+    // Large tables are parsed in slices on this pool; without one, loading is sequential
+    void setThreadPool(ThreadPool* workers) { pool = workers; }
+
     // Load operations
-    std::vector<Passenger> loadPassengers();
-    std::vector<Flight> loadFlights();
-    std::vector<Reservation> loadReservations();
+    std::deque<Passenger> loadPassengers();
+    std::deque<Flight> loadFlights();
+    std::deque<Reservation> loadReservations();
+    // Loads the three CSV tables concurrently
+    void loadTables(std::deque<Passenger>& passengers,
+                    std::deque<Flight>& flights,
+                    std::deque<Reservation>& reservations);
+
+    // Streams the rows of any CSV file, such as a bulk import, without copying it into memory
+    void forEachRow(const std::string& path, const std::function<void(const CsvRow&)>& visit);
+
+    // Save operations: rewrite the whole file, or append the rows from append_from on
+    void savePassengers(const std::deque<Passenger>& passengers, size_t append_from = 0);
+    void saveFlights(const std::deque<Flight>& flights, size_t append_from = 0);
+    void saveReservations(const std::deque<Reservation>& reservations, size_t append_from = 0);
+
+    // Serialize now, write later: used by the background flusher
+    TableImage passengersImage(const std::deque<Passenger>& passengers, size_t append_from = 0);
+    TableImage flightsImage(const std::deque<Flight>& flights, size_t append_from = 0);
+    TableImage reservationsImage(const std::deque<Reservation>& reservations, size_t append_from = 0);
+    TableImage sequencesImage(const IdSequences& sequences);
+    void saveTableImage(const TableImage& image);
+
+    // Next ids of the CSV tables; joins an open commit group like the tables do
+    IdSequences loadSequences();
+    void saveSequences(const IdSequences& sequences);
+
+    // Saves between beginCommit and commitTables replace the live files as one
+    // group; outside a group every save commits on its own.
+    void setDurability(Durability level) { durability = level; }
+    Durability getDurability() const { return durability; }
+    void beginCommit();
+    void commitTables();
+    void abortCommit();
+    // Finishes a commit interrupted after its intent file was written and
+    // discards temporary files from one that never got that far
+    void recoverCommit();
+
+    // Binary snapshot: versioned fixed-size records plus a string pool, read back through mmap
+    void setSnapshotFormat(SnapshotFormat format) { snapshot_format = format; }
+    SnapshotFormat getSnapshotFormat() const { return snapshot_format; }
+    bool hasBinarySnapshot();
+    void saveBinarySnapshot(const std::deque<Passenger>& passengers,
+                            const std::deque<Flight>& flights,
+                            const std::deque<Reservation>& reservations,
+                            const IdSequences& sequences);
+    std::string binarySnapshotImage(const std::deque<Passenger>& passengers,
+                                    const std::deque<Flight>& flights,
+                                    const std::deque<Reservation>& reservations,
+                                    const IdSequences& sequences);
+    void saveBinaryImage(const std::string& image);
+    // Returns the id sequences stored with the snapshot
+    IdSequences loadBinarySnapshot(std::deque<Passenger>& passengers,
+                                   std::deque<Flight>& flights,
+                                   std::deque<Reservation>& reservations);
+    void convertCsvToBinary();
+    void convertBinaryToCsv();
 
-    // Save operations
-    void savePassengers(const std::vector<Passenger>& passengers);
-    void saveFlights(const std::vector<Flight>& flights);
-    void saveReservations(const std::vector<Reservation>& reservations);
+    // Write-ahead journal: each record is a group of "P,"/"F,"/"R," row lines closed by a "C" line
+    void appendJournal(const std::string& record);
+    size_t replayJournal(std::deque<Passenger>& passengers,
+                         std::deque<Flight>& flights,
+                         std::deque<Reservation>& reservations);
+    void clearJournal();
 
     // Report generation
     void generateReport(const std::string& filename, const std::string& content);
     void generatePassengerReport(const std::string& filename, 
                                const Passenger& passenger,
-                               const std::vector<Reservation>& reservations);
+                               const std::deque<Reservation>& reservations);
     void generateFlightReport(const std::string& filename, 
                             const Flight& flight,
-                            const std::vector<Reservation>& reservations,
-                            const std::vector<Passenger>& passengers);
+                            const std::deque<Reservation>& reservations,
+                            const std::deque<Passenger>& passengers);
     void generateReservationsReport(const std::string& filename,
-                                  const std::vector<Reservation>& reservations,
-                                  const std::vector<Passenger>& passengers,
-                                  const std::vector<Flight>& flights);
+                                  const std::deque<Reservation>& reservations,
+                                  const std::deque<Passenger>& passengers,
+                                  const std::deque<Flight>& flights);
 
-    // Validation methods
+    // Validation methods, applied when rows are inserted or updated rather than on every save
     void validatePassengerData(const Passenger& passenger);
     void validateFlightData(const Flight& flight);
     void validateReservationData(const Reservation& reservation);
@@ -0,0 +1,152 @@
+#include "FilterKernels.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define FILTER_KERNELS_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr size_t WORD_BITS = 64;
+
+// Scalar kernels, run over the words from first_word on; they also finish the
+// partial last word the AVX2 kernels leave behind
+template <typename Test>
+void applyScalar(size_t first_word, size_t rows, uint64_t* bits, Test test) {
+    for (size_t word = first_word; word * WORD_BITS < rows; ++word) {
+        size_t base = word * WORD_BITS;
+        size_t count = rows - base < WORD_BITS ? rows - base : WORD_BITS;
+        uint64_t keep = 0;
+        for (size_t i = 0; i < count; ++i) {
+            keep |= static_cast<uint64_t>(test(base + i)) << i;
+        }
+        bits[word] &= keep;
+    }
+}
+
+size_t lowestBit(uint64_t word) {
+#ifdef __GNUC__
+    return static_cast<size_t>(__builtin_ctzll(word));
+#else
+    size_t bit = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+#ifdef FILTER_KERNELS_AVX2
+
+// AVX2 kernels fill whole 64-row words and return how many they did
+
+__attribute__((target("avx2")))
+size_t compareLessAvx2(const int64_t* values, size_t rows, int64_t limit, bool below, uint64_t* bits) {
+    const __m256i limits = _mm256_set1_epi64x(limit);
+    size_t words = rows / WORD_BITS;
+    for (size_t word = 0; word < words; ++word) {
+        const int64_t* base = values + word * WORD_BITS;
+        uint64_t keep = 0;
+        for (size_t i = 0; i < WORD_BITS; i += 4) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i));
+            __m256i less = _mm256_cmpgt_epi64(limits, v);
+            keep |= static_cast<uint64_t>(_mm256_movemask_pd(_mm256_castsi256_pd(less))) << i;
+        }
+        bits[word] &= below ? keep : ~keep;
+    }
+    return words;
+}
+
+__attribute__((target("avx2")))
+size_t flagsEqualAvx2(const uint8_t* flags, size_t rows, uint8_t mask, uint8_t expected, uint64_t* bits) {
+    const __m256i masks = _mm256_set1_epi8(static_cast<char>(mask));
+    const __m256i wanted = _mm256_set1_epi8(static_cast<char>(expected));
+    size_t words = rows / WORD_BITS;
+    for (size_t word = 0; word < words; ++word) {
+        const uint8_t* base = flags + word * WORD_BITS;
+        __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base));
+        __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + 32));
+        uint32_t low_keep = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(low, masks), wanted)));
+        uint32_t high_keep = static_cast<uint32_t>(
+            _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_and_si256(high, masks), wanted)));
+        bits[word] &= static_cast<uint64_t>(high_keep) << 32 | low_keep;
+    }
+    return words;
+}
+
+__attribute__((target("avx2")))
+size_t idEqualAvx2(const int32_t* ids, size_t rows, int32_t id, uint64_t* bits) {
+    const __m256i wanted = _mm256_set1_epi32(id);
+    size_t words = rows / WORD_BITS;
+    for (size_t word = 0; word < words; ++word) {
+        const int32_t* base = ids + word * WORD_BITS;
+        uint64_t keep = 0;
+        for (size_t i = 0; i < WORD_BITS; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(base + i));
+            __m256i equal = _mm256_cmpeq_epi32(v, wanted);
+            keep |= static_cast<uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(equal))) << i;
+        }
+        bits[word] &= keep;
+    }
+    return words;
+}
+
+bool detectAvx2() {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+}
+
+#endif
+
+}
+
+bool FilterKernels::usesAvx2() {
+#ifdef FILTER_KERNELS_AVX2
+    static const bool supported = detectAvx2();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+std::vector<uint64_t> FilterKernels::allRows(size_t rows) {
+    std::vector<uint64_t> bits((rows + WORD_BITS - 1) / WORD_BITS, ~uint64_t(0));
+    if (rows % WORD_BITS != 0) {
+        bits.back() = (uint64_t(1) << (rows % WORD_BITS)) - 1;
+    }
+    return bits;
+}
+
+void FilterKernels::compareLess(const int64_t* values, size_t rows, int64_t limit, bool below, uint64_t* bits) {
+    size_t done = 0;
+#ifdef FILTER_KERNELS_AVX2
+    if (usesAvx2()) done = compareLessAvx2(values, rows, limit, below, bits);
+#endif
+    applyScalar(done, rows, bits, [=](size_t r) { return (values[r] < limit) == below; });
+}
+
+void FilterKernels::flagsEqual(const uint8_t* flags, size_t rows, uint8_t mask, uint8_t expected, uint64_t* bits) {
+    size_t done = 0;
+#ifdef FILTER_KERNELS_AVX2
+    if (usesAvx2()) done = flagsEqualAvx2(flags, rows, mask, expected, bits);
+#endif
+    applyScalar(done, rows, bits, [=](size_t r) { return (flags[r] & mask) == expected; });
+}
+
+void FilterKernels::idEqual(const int32_t* ids, size_t rows, int32_t id, uint64_t* bits) {
+    size_t done = 0;
+#ifdef FILTER_KERNELS_AVX2
+    if (usesAvx2()) done = idEqualAvx2(ids, rows, id, bits);
+#endif
+    applyScalar(done, rows, bits, [=](size_t r) { return ids[r] == id; });
+}
+
+void FilterKernels::collect(const std::vector<uint64_t>& bits, std::vector<size_t>& rows) {
+    for (size_t word = 0; word < bits.size(); ++word) {
+        for (uint64_t rest = bits[word]; rest != 0; rest &= rest - 1) {
+            rows.push_back(word * WORD_BITS + lowestBit(rest));
+        }
+    }
+}
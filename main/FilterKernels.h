@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Predicates over whole columns. Each kernel ANDs one bit per row into a
+// selection bitmap (bit r % 64 of word r / 64), so several predicates narrow
+// the same bitmap. AVX2 versions are picked at runtime when the CPU has them,
+// with scalar loops as the fallback.
+class FilterKernels {
+public:
+    // A bitmap with the first `rows` bits set
+    static std::vector<uint64_t> allRows(size_t rows);
+
+    // Keeps rows whose value is < limit (below = true) or >= limit (below = false)
+    static void compareLess(const int64_t* values, size_t rows, int64_t limit, bool below, uint64_t* bits);
+    // Keeps rows where (flags & mask) == expected
+    static void flagsEqual(const uint8_t* flags, size_t rows, uint8_t mask, uint8_t expected, uint64_t* bits);
+    // Keeps rows equal to id
+    static void idEqual(const int32_t* ids, size_t rows, int32_t id, uint64_t* bits);
+
+    // Appends the positions of set bits, ascending
+    static void collect(const std::vector<uint64_t>& bits, std::vector<size_t>& rows);
+
+    static bool usesAvx2();
+};
@@ -1,81 +1,104 @@
 #include "Flight.h"
-#include <sstream>
-#include <iomanip>
-
-static int next_flight_id = 1;
+#include "CsvReader.h"
+#include "CsvWriter.h"
 
 Flight::Flight(const std::string& flight_number, const std::string& origin,
                const std::string& destination, time_t departure_time,
                int available_seats, double ticket_price) {
-    this->flight_id = next_flight_id++;
+    this->flight_id = 0;  // Assigned by AirlineSystem when the flight is added
     this->flight_number = flight_number;
     this->origin = origin;
     this->destination = destination;
     this->departure_time = departure_time;
     this->available_seats = available_seats;
+    this->capacity = available_seats;
     this->ticket_price = ticket_price;
     this->is_deleted = false;
 }
 
+Flight::Flight(int flight_id, std::string flight_number, std::string origin,
+               std::string destination, time_t departure_time,
+               int available_seats, int capacity, double ticket_price, bool is_deleted)
+    : flight_id(flight_id), flight_number(std::move(flight_number)), origin(std::move(origin)),
+      destination(std::move(destination)), departure_time(departure_time),
+      available_seats(available_seats), capacity(capacity), ticket_price(ticket_price),
+      is_deleted(is_deleted) {}
+
+Flight::Flight(const Flight& other)
+    : flight_id(other.flight_id), flight_number(other.flight_number), origin(other.origin),
+      destination(other.destination), departure_time(other.departure_time),
+      available_seats(other.getAvailableSeats()), capacity(other.capacity),
+      ticket_price(other.ticket_price), is_deleted(other.is_deleted) {}
+
+Flight& Flight::operator=(const Flight& other) {
+    flight_id = other.flight_id;
+    flight_number = other.flight_number;
+    origin = other.origin;
+    destination = other.destination;
+    departure_time = other.departure_time;
+    available_seats.store(other.getAvailableSeats(), std::memory_order_release);
+    capacity = other.capacity;
+    ticket_price = other.ticket_price;
+    is_deleted = other.is_deleted;
+    return *this;
+}
+
+Flight Flight::restore(int flight_id, std::string flight_number, std::string origin,
+                       std::string destination, time_t departure_time,
+                       int available_seats, double ticket_price, bool is_deleted, int capacity) {
+    return Flight(flight_id, std::move(flight_number), std::move(origin), std::move(destination),
+                  departure_time, available_seats, capacity, ticket_price, is_deleted);
+}
+
 bool Flight::reserveSeat() {
-    if (available_seats > 0) {
-        available_seats--;
-        return true;
-    }
-    return false;
+    int seats = available_seats.load(std::memory_order_acquire);
+    do {
+        if (seats <= 0) {
+            return false;
+        }
+    } while (!available_seats.compare_exchange_weak(seats, seats - 1, std::memory_order_acq_rel));
+    return true;
 }
 
 bool Flight::cancelSeat() {
-    available_seats++;
+    int seats = available_seats.load(std::memory_order_acquire);
+    do {
+        if (hasCapacity() && seats >= capacity) {
+            return false;
+        }
+    } while (!available_seats.compare_exchange_weak(seats, seats + 1, std::memory_order_acq_rel));
     return true;
 }
 
 std::string Flight::toCSV() const {
-    std::stringstream ss;
-    ss << flight_id << ","
-       << flight_number << ","
-       << origin << ","
-       << destination << ","
-       << departure_time << ","
-       << available_seats << ","
-       << std::fixed << std::setprecision(2) << ticket_price << ","
-       << (is_deleted ? "1" : "0");
-    return ss.str();
+    std::string line;
+    appendCSV(line);
+    return line;
 }
 
-Flight Flight::fromCSV(const std::string& csv_line) {
-    std::stringstream ss(csv_line);
-    std::string token;
-    
-    // Read fields
-    std::getline(ss, token, ',');
-    int id = std::stoi(token);
-    
-    std::string flight_num, orig, dest;
-    std::getline(ss, flight_num, ',');
-    std::getline(ss, orig, ',');
-    std::getline(ss, dest, ',');
-    
-    std::getline(ss, token, ',');
-    time_t dep_time = std::stoll(token);
-    
-    std::getline(ss, token, ',');
-    int seats = std::stoi(token);
-    
-    std::getline(ss, token, ',');
-    double price = std::stod(token);
-    
-    std::getline(ss, token, ',');
-    bool deleted = (token == "1");
-    
-    // Create flight
-    Flight f(flight_num, orig, dest, dep_time, seats, price);
-    f.flight_id = id;
-    f.is_deleted = deleted;
-    
-    if (id >= next_flight_id) {
-        next_flight_id = id + 1;
+void Flight::appendCSV(std::string& out) const {
+    CsvLineWriter line(out);
+    line.integer(flight_id)
+        .text(flight_number)
+        .text(origin)
+        .text(destination)
+        .integer(departure_time)
+        .integer(getAvailableSeats())
+        .fixed(ticket_price, 2)
+        .flag(is_deleted);
+    // Rows without a known capacity keep the old eight-column layout
+    if (hasCapacity()) {
+        line.integer(capacity);
     }
-    
-    return f;
+}
+
+Flight Flight::fromCSV(const std::string& csv_line) {
+    return fromFields(CsvRow(csv_line));
+}
+
+Flight Flight::fromFields(const CsvRow& row) {
+    return restore(row.toInt(0), std::string(row.text(1)), std::string(row.text(2)),
+                   std::string(row.text(3)), static_cast<time_t>(row.toInt64(4)),
+                   row.toInt(5), row.toDouble(6), row.toFlag(7),
+                   row.has(8) ? row.toInt(8) : UNKNOWN_CAPACITY);
 }
@@ -1,6 +1,9 @@
 #pragma once
 #include <string>
 #include <ctime>
+#include <atomic>
+
+class CsvRow;
 
 class Flight {
 private:
@@ -9,31 +12,57 @@ private:
     std::string origin;
     std::string destination;
     time_t departure_time;
-    int available_seats;
+    // Changed by compare-and-swap only, so concurrent bookings of one flight need no lock
+    std::atomic<int> available_seats;
+    // Seats the flight was created with; bounds cancelSeat
+    int capacity;
     double ticket_price;
     bool is_deleted;
 
+    Flight(int flight_id, std::string flight_number, std::string origin,
+           std::string destination, time_t departure_time,
+           int available_seats, int capacity, double ticket_price, bool is_deleted);
+
 public:
+    // Capacity of flights stored before it was recorded, until setCapacity fills it in
+    static constexpr int UNKNOWN_CAPACITY = -1;
+
     Flight(const std::string& flight_number, const std::string& origin,
            const std::string& destination, time_t departure_time,
            int available_seats, double ticket_price);
+    Flight(const Flight& other);
+    Flight& operator=(const Flight& other);
 
     // Getters
     int getFlightId() const { return flight_id; }
-    std::string getFlightNumber() const { return flight_number; }
-    std::string getOrigin() const { return origin; }
-    std::string getDestination() const { return destination; }
+    const std::string& getFlightNumber() const { return flight_number; }
+    const std::string& getOrigin() const { return origin; }
+    const std::string& getDestination() const { return destination; }
     time_t getDepartureTime() const { return departure_time; }
-    int getAvailableSeats() const { return available_seats; }
+    int getAvailableSeats() const { return available_seats.load(std::memory_order_acquire); }
+    int getCapacity() const { return capacity; }
+    bool hasCapacity() const { return capacity != UNKNOWN_CAPACITY; }
     double getTicketPrice() const { return ticket_price; }
     bool isDeleted() const { return is_deleted; }
 
     // Operations
+    // Takes one seat; false once the flight is sold out
     bool reserveSeat();
+    // Returns one seat; false if every seat is already free
     bool cancelSeat();
+    void setFlightId(int flight_id) { this->flight_id = flight_id; }
+    void setCapacity(int capacity) { this->capacity = capacity; }
     void softDelete() { is_deleted = true; }
 
     // For file operations
     std::string toCSV() const;
+    // Appends the toCSV() text without a line ending
+    void appendCSV(std::string& out) const;
     static Flight fromCSV(const std::string& csv_line);
+    static Flight fromFields(const CsvRow& row);
+    // Rebuilds a stored flight with its original id
+    static Flight restore(int flight_id, std::string flight_number, std::string origin,
+                          std::string destination, time_t departure_time,
+                          int available_seats, double ticket_price, bool is_deleted,
+                          int capacity = UNKNOWN_CAPACITY);
 };
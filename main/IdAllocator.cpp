@@ -0,0 +1,43 @@
+#include "IdAllocator.h"
+#include <array>
+#include <cstddef>
+
+namespace {
+
+std::atomic<uint64_t> last_serial{0};
+
+// A thread's blocks from the few allocators it used last; trivial, so the
+// thread_local cache below needs no per-access init guard
+struct ThreadBlock {
+    uint64_t serial;
+    int next;
+    int end;
+};
+constexpr size_t CACHED_BLOCKS = 4;
+
+}
+
+IdAllocator::IdAllocator(int thread_block)
+    : serial(last_serial.fetch_add(1, std::memory_order_relaxed) + 1),
+      thread_block(thread_block > 1 ? thread_block : 1) {}
+
+int IdAllocator::next() {
+    if (thread_block == 1) {
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+    thread_local std::array<ThreadBlock, CACHED_BLOCKS> blocks{};
+    ThreadBlock& block = blocks[serial % CACHED_BLOCKS];
+    if (block.serial != serial || block.next == block.end) {
+        // An evicted block's remaining ids become a gap
+        block.serial = serial;
+        block.next = reserveBlock(thread_block);
+        block.end = block.next + thread_block;
+    }
+    return block.next++;
+}
+
+void IdAllocator::observe(int id) {
+    int next = next_id.load(std::memory_order_relaxed);
+    while (id >= next && !next_id.compare_exchange_weak(next, id + 1, std::memory_order_relaxed)) {
+    }
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Next free id of each table. Saved with the snapshot, so ids of rows that no
+// longer appear in any file are still never handed out again.
+struct IdSequences {
+    int passenger = 1;
+    int flight = 1;
+    int reservation = 1;
+};
+
+// Hands out the ids of one table. The counter has a cache line to itself, so
+// allocating passenger ids never contends with allocating reservation ids.
+//
+// With a thread block above 1, next() gives each thread a private block of that
+// many ids and only touches the shared counter to take the next block. peek() is
+// then past the unused rest of every block, so a caller that saves the sequence
+// should save one past the highest id it actually issued; the next run observes
+// that and carries on without a gap.
+class IdAllocator {
+private:
+    // Tells this allocator's blocks apart in the per-thread caches, even from
+    // an earlier allocator at the same address
+    const uint64_t serial;
+    const int thread_block;
+    alignas(64) std::atomic<int> next_id{1};
+
+public:
+    explicit IdAllocator(int thread_block = 1);
+    IdAllocator(const IdAllocator&) = delete;
+    IdAllocator& operator=(const IdAllocator&) = delete;
+
+    int next();
+    // Reserves `count` consecutive ids for one caller and returns the first.
+    // Batches take exactly what they need, so blocks leave no gaps.
+    int reserveBlock(int count) { return next_id.fetch_add(count, std::memory_order_relaxed); }
+    // Makes sure `id` is never handed out again
+    void observe(int id);
+    // The id the shared counter hands out next; past every id already handed out,
+    // and with thread blocks past the ids still waiting in them too
+    int peek() const { return next_id.load(std::memory_order_relaxed); }
+};
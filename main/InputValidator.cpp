@@ -62,7 +62,7 @@ int InputValidator::getValidatedInteger(const std::string& prompt, int minDigits
             continue;
         }
         
-        if (input.length() < minDigits || input.length() > maxDigits) {
+        if (input.length() < static_cast<size_t>(minDigits) || input.length() > static_cast<size_t>(maxDigits)) {
             std::cout << "Error: Number must be between " << minDigits 
                       << " and " << maxDigits << " digits.\n";
             continue;
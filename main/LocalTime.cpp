@@ -0,0 +1,212 @@
+#include "LocalTime.h"
+#include <array>
+#include <atomic>
+#include <cstdio>
+
+namespace {
+
+constexpr int64_t SECONDS_PER_DAY = 24 * 60 * 60;
+constexpr size_t OFFSET_CACHE_DAYS = 1024;
+constexpr int NO_TRANSITION = -1;
+
+// Bumped by clearCache; each thread drops its cache when it sees a new value
+std::atomic<unsigned> cache_generation{0};
+
+// Offsets of one UTC day: the offset at its start and, if the zone changes
+// offset during the day, the second of the change and the offset after it.
+// Trivial, so the thread_local cache below needs no per-access init guard.
+struct DayOffsets {
+    int64_t day;
+    int start_offset;
+    int transition;
+    int end_offset;
+    bool valid;
+};
+
+// Rounds toward negative infinity; a constant divisor lets the compiler use a multiply
+template <int64_t Divisor>
+int64_t floorDiv(int64_t value) {
+    static_assert(Divisor > 0, "floorDiv needs a positive divisor");
+    int64_t quotient = value / Divisor;
+    return quotient * Divisor > value ? quotient - 1 : quotient;
+}
+
+// Days since 1970-01-01 of a proleptic Gregorian date (H. Hinnant's days_from_civil)
+int64_t daysFromCivil(int64_t year, int month, int day) {
+    year -= month <= 2;
+    int64_t era = floorDiv<400>(year);
+    int64_t year_of_era = year - era * 400;
+    int64_t day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    int64_t day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+void civilFromDays(int64_t days, int64_t& year, int& month, int& day) {
+    days += 719468;
+    int64_t era = floorDiv<146097>(days);
+    int64_t day_of_era = days - era * 146097;
+    int64_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    int64_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    int64_t month_index = (5 * day_of_year + 2) / 153;
+    day = static_cast<int>(day_of_year - (153 * month_index + 2) / 5 + 1);
+    month = static_cast<int>(month_index < 10 ? month_index + 3 : month_index - 9);
+    year = year_of_era + era * 400 + (month <= 2);
+}
+
+int lookupOffset(time_t t) {
+    tm local{};
+#ifdef _WIN32
+    if (localtime_s(&local, &t) != 0) return 0;
+#else
+    if (!localtime_r(&t, &local)) return 0;
+#endif
+    int64_t local_seconds = daysFromCivil(local.tm_year + 1900, local.tm_mon + 1, local.tm_mday) * SECONDS_PER_DAY +
+                            local.tm_hour * 3600 + local.tm_min * 60 + local.tm_sec;
+    return static_cast<int>(local_seconds - static_cast<int64_t>(t));
+}
+
+// Assumes at most one offset change per UTC day, which holds for every zone in use
+DayOffsets offsetsOfDay(int64_t day) {
+    DayOffsets offsets{};
+    offsets.day = day;
+    offsets.transition = NO_TRANSITION;
+    offsets.valid = true;
+    time_t start = static_cast<time_t>(day * SECONDS_PER_DAY);
+    offsets.start_offset = lookupOffset(start);
+    offsets.end_offset = lookupOffset(static_cast<time_t>(start + SECONDS_PER_DAY - 1));
+    if (offsets.end_offset != offsets.start_offset) {
+        // Binary search for the first second with the new offset
+        int64_t low = 0, high = SECONDS_PER_DAY - 1;
+        while (low + 1 < high) {
+            int64_t middle = (low + high) / 2;
+            if (lookupOffset(static_cast<time_t>(start + middle)) == offsets.start_offset) {
+                low = middle;
+            } else {
+                high = middle;
+            }
+        }
+        offsets.transition = static_cast<int>(high);
+    }
+    return offsets;
+}
+
+int64_t localSeconds(time_t t) {
+    return static_cast<int64_t>(t) + LocalTime::utcOffset(t);
+}
+
+void writeTwoDigits(char* out, int value) {
+    out[0] = static_cast<char>('0' + value / 10);
+    out[1] = static_cast<char>('0' + value % 10);
+}
+
+}
+
+int LocalTime::utcOffset(time_t t) {
+    // Per thread, so lookups take no lock and share no cache lines
+    thread_local std::array<DayOffsets, OFFSET_CACHE_DAYS> cache;
+    thread_local unsigned generation = 0;
+    unsigned current = cache_generation.load(std::memory_order_acquire);
+    if (generation != current) {
+        cache.fill(DayOffsets{});
+        generation = current;
+    }
+
+    int64_t day = floorDiv<SECONDS_PER_DAY>(static_cast<int64_t>(t));
+    DayOffsets& entry = cache[static_cast<uint64_t>(day) % OFFSET_CACHE_DAYS];
+    if (!entry.valid || entry.day != day) {
+        entry = offsetsOfDay(day);
+    }
+    if (entry.transition != NO_TRANSITION &&
+        static_cast<int64_t>(t) - day * SECONDS_PER_DAY >= entry.transition) {
+        return entry.end_offset;
+    }
+    return entry.start_offset;
+}
+
+int64_t LocalTime::dayNumber(time_t t) {
+    return floorDiv<SECONDS_PER_DAY>(localSeconds(t));
+}
+
+CivilTime LocalTime::civil(time_t t) {
+    int64_t local = localSeconds(t);
+    int64_t days = floorDiv<SECONDS_PER_DAY>(local);
+    int64_t seconds = local - days * SECONDS_PER_DAY;
+
+    // Neighbouring report rows usually share a day, so each thread keeps its last date
+    struct LastDate {
+        int64_t days;
+        int year;
+        int month;
+        int day;
+        bool valid;
+    };
+    thread_local LastDate last{};
+    if (!last.valid || last.days != days) {
+        int64_t year;
+        civilFromDays(days, year, last.month, last.day);
+        last.year = static_cast<int>(year);
+        last.days = days;
+        last.valid = true;
+    }
+
+    CivilTime civil;
+    civil.year = last.year;
+    civil.month = last.month;
+    civil.day = last.day;
+    civil.hour = static_cast<int>(seconds / 3600);
+    civil.minute = static_cast<int>(seconds / 60 % 60);
+    civil.second = static_cast<int>(seconds % 60);
+    civil.weekday = static_cast<int>(days + 4 - floorDiv<7>(days + 4) * 7);  // 1970-01-01 was a Thursday
+    return civil;
+}
+
+time_t LocalTime::dayStart(time_t t, int day_offset) {
+    CivilTime date = civil(t);
+    tm day_tm{};
+    day_tm.tm_year = date.year - 1900;
+    day_tm.tm_mon = date.month - 1;
+    day_tm.tm_mday = date.day + day_offset;
+    day_tm.tm_isdst = -1;
+    return std::mktime(&day_tm);
+}
+
+const char* LocalTime::formatDate(time_t t, char (&out)[11]) {
+    CivilTime date = civil(t);
+    if (date.year < 0 || date.year > 9999) {
+        std::snprintf(out, sizeof(out), "%04d-%02d-%02d", date.year, date.month, date.day);
+        return out;
+    }
+    writeTwoDigits(out, date.year / 100);
+    writeTwoDigits(out + 2, date.year % 100);
+    out[4] = '-';
+    writeTwoDigits(out + 5, date.month);
+    out[7] = '-';
+    writeTwoDigits(out + 8, date.day);
+    out[10] = '\0';
+    return out;
+}
+
+const char* LocalTime::formatTime(time_t t, char (&out)[9]) {
+    CivilTime time = civil(t);
+    writeTwoDigits(out, time.hour);
+    out[2] = ':';
+    writeTwoDigits(out + 3, time.minute);
+    out[5] = ':';
+    writeTwoDigits(out + 6, time.second);
+    out[8] = '\0';
+    return out;
+}
+
+const char* LocalTime::formatCtime(time_t t, char (&out)[26]) {
+    static const char* const WEEKDAYS[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static const char* const MONTHS[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                         "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+    CivilTime time = civil(t);
+    std::snprintf(out, sizeof(out), "%.3s %.3s%3d %.2d:%.2d:%.2d %d\n", WEEKDAYS[time.weekday],
+                  MONTHS[time.month - 1], time.day, time.hour, time.minute, time.second, time.year);
+    return out;
+}
+
+void LocalTime::clearCache() {
+    cache_generation.fetch_add(1, std::memory_order_release);
+}
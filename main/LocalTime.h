@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include <ctime>
+
+// Local calendar fields of one instant
+struct CivilTime {
+    int year;
+    int month;      // 1-12
+    int day;        // 1-31
+    int hour;
+    int minute;
+    int second;
+    int weekday;    // 0 = Sunday
+};
+
+// Reentrant local-time conversions for per-row use. Each thread caches the UTC
+// offsets of the days it has seen, including any offset change inside a day, so
+// after the first lookup of a day an instant becomes a civil date with integer
+// arithmetic alone. Every function formats into the caller's buffer, so all of
+// them are safe across threads. Call clearCache() after changing the timezone.
+class LocalTime {
+public:
+    // Seconds east of UTC in effect at t
+    static int utcOffset(time_t t);
+    // Local days since 1970-01-01; equal numbers mean the same local date
+    static int64_t dayNumber(time_t t);
+    static CivilTime civil(time_t t);
+    // Local midnight `day_offset` days after the day containing t. Goes through
+    // mktime, so days that start inside a DST change come out right.
+    static time_t dayStart(time_t t, int day_offset = 0);
+
+    // The same text as strftime "%Y-%m-%d", "%H:%M:%S" and ctime (newline included)
+    static const char* formatDate(time_t t, char (&out)[11]);
+    static const char* formatTime(time_t t, char (&out)[9]);
+    static const char* formatCtime(time_t t, char (&out)[26]);
+
+    static void clearCache();
+};
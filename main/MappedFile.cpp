@@ -0,0 +1,65 @@
+#include "MappedFile.h"
+#include "AirlineExceptions.h"
+
+#ifdef _WIN32
+#include <fstream>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        throw FileOperationException("open " + path);
+    }
+    buffer.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    if (!buffer.empty() && !file.read(buffer.data(), buffer.size())) {
+        throw FileOperationException("read " + path);
+    }
+    bytes = buffer.data();
+    length = buffer.size();
+}
+
+MappedFile::~MappedFile() {}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw FileOperationException("open " + path);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw FileOperationException("stat " + path);
+    }
+
+    length = static_cast<size_t>(info.st_size);
+    if (length > 0) {
+        void* mapping = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw FileOperationException("mmap " + path);
+        }
+        ::madvise(mapping, length, MADV_SEQUENTIAL);
+        bytes = static_cast<const char*>(mapping);
+    }
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (bytes) {
+        ::munmap(const_cast<char*>(bytes), length);
+    }
+}
+
+#endif
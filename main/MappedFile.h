@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#ifdef _WIN32
+#include <vector>
+#endif
+
+// Read-only view of a whole file. On POSIX systems the file is mmapped, so
+// reading it costs page faults rather than copies; elsewhere it is read into memory.
+class MappedFile {
+private:
+    const char* bytes = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    std::vector<char> buffer;
+#endif
+
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* data() const { return bytes; }
+    size_t size() const { return length; }
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ThreadPool.h"
+
+// Rows below this are formatted on the calling thread
+constexpr size_t MIN_PARALLEL_ROWS = 4096;
+
+// Formats rows [0, count) in slices on the pool and writes the slices to outs in
+// order. One pass can feed several outputs: format_rows(buffers, begin, end) gets
+// one buffer per output, each starting with its output's formatting state. The
+// result is byte-identical to calling format_rows(outs, 0, count). format_rows
+// runs concurrently on disjoint ranges, so it may only read shared data.
+template <typename Format>
+void writeOrdered(const std::vector<std::ostream*>& outs, ThreadPool* pool, size_t count, Format format_rows) {
+    size_t parts = pool ? std::min(pool->size() * 4, count / MIN_PARALLEL_ROWS) : 1;
+    if (parts <= 1) {
+        format_rows(outs, 0, count);
+        return;
+    }
+
+    std::vector<std::future<std::vector<std::string>>> slices;
+    for (size_t part = 0; part < parts; ++part) {
+        size_t begin = count * part / parts;
+        size_t end = count * (part + 1) / parts;
+        slices.push_back(pool->submit([&outs, &format_rows, begin, end]() {
+            std::vector<std::ostringstream> buffers(outs.size());
+            std::vector<std::ostream*> targets;
+            for (size_t i = 0; i < outs.size(); ++i) {
+                buffers[i].copyfmt(*outs[i]);
+                targets.push_back(&buffers[i]);
+            }
+            format_rows(targets, begin, end);
+            std::vector<std::string> texts;
+            for (auto& buffer : buffers) texts.push_back(buffer.str());
+            return texts;
+        }));
+    }
+    // Earlier slices are written while later ones are still formatting. Every slice
+    // reads the caller's data, so a failure is only rethrown once all have finished.
+    std::exception_ptr failure;
+    for (auto& slice : slices) {
+        try {
+            if (failure) {
+                slice.wait();
+            } else {
+                std::vector<std::string> texts = slice.get();
+                for (size_t i = 0; i < outs.size(); ++i) *outs[i] << texts[i];
+            }
+        } catch (...) {
+            failure = std::current_exception();
+        }
+    }
+    if (failure) {
+        std::rethrow_exception(failure);
+    }
+}
+
+// Single-output form: format_rows(buffer, begin, end)
+template <typename Format>
+void writeOrdered(std::ostream& out, ThreadPool* pool, size_t count, Format format_rows) {
+    writeOrdered(std::vector<std::ostream*>{&out}, pool, count,
+                 [&format_rows](const std::vector<std::ostream*>& buffers, size_t begin, size_t end) {
+                     format_rows(*buffers[0], begin, end);
+                 });
+}
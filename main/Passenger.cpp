@@ -1,12 +1,11 @@
 #include "Passenger.h"
-#include <sstream>
+#include "CsvReader.h"
+#include "CsvWriter.h"
 #include <iostream>
 
-static int next_passenger_id = 1;
-
 Passenger::Passenger(const std::string& name, const std::string& passport_number,
                    const std::string& national_id, const std::string& nationality) {
-    this->passenger_id = next_passenger_id++;
+    this->passenger_id = 0;  // Assigned by AirlineSystem when the passenger is added
     this->name = name;
     this->passport_number = passport_number;
     this->national_id = national_id;
@@ -15,51 +14,43 @@ Passenger::Passenger(const std::string& name, const std::string& passport_number
     this->is_deleted = false;
 }
 
+Passenger::Passenger(int passenger_id, std::string name, std::string passport_number,
+                     std::string national_id, std::string nationality,
+                     double wallet_balance, bool is_deleted)
+    : passenger_id(passenger_id), name(std::move(name)), passport_number(std::move(passport_number)),
+      national_id(std::move(national_id)), nationality(std::move(nationality)),
+      wallet_balance(wallet_balance), is_deleted(is_deleted) {}
+
+Passenger Passenger::restore(int passenger_id, std::string name, std::string passport_number,
+                             std::string national_id, std::string nationality,
+                             double wallet_balance, bool is_deleted) {
+    return Passenger(passenger_id, std::move(name), std::move(passport_number), std::move(national_id),
+                     std::move(nationality), wallet_balance, is_deleted);
+}
+
 std::string Passenger::toCSV() const {
-    std::stringstream ss;
-    ss << passenger_id << "," 
-       << name << "," 
-       << passport_number << "," 
-       << national_id << "," 
-       << nationality << "," 
-       << wallet_balance << "," 
-       << (is_deleted ? "1" : "0");
-    return ss.str();
+    std::string line;
+    appendCSV(line);
+    return line;
+}
+
+void Passenger::appendCSV(std::string& out) const {
+    CsvLineWriter(out)
+        .integer(passenger_id)
+        .text(name)
+        .text(passport_number)
+        .text(national_id)
+        .text(nationality)
+        .number(wallet_balance)
+        .flag(is_deleted);
 }
 
 Passenger Passenger::fromCSV(const std::string& csv_line) {
-    std::stringstream ss(csv_line);
-    std::string token;
-    
-    // Read fields
-    std::getline(ss, token, ',');
-    int id = std::stoi(token);
-    
-    std::string name, passport, national_id, nationality;
-    double balance;
-    bool deleted;
-    
-    std::getline(ss, name, ',');
-    std::getline(ss, passport, ',');
-    std::getline(ss, national_id, ',');
-    std::getline(ss, nationality, ',');
-    
-    std::getline(ss, token, ',');
-    balance = std::stod(token);
-    
-    std::getline(ss, token, ',');
-    deleted = (token == "1");
-    
-    // Create passenger
-    Passenger p(name, passport, national_id, nationality);
-    p.passenger_id = id;
-    p.wallet_balance = balance;
-    p.is_deleted = deleted;
-    
-    // Update next_passenger_id if necessary
-    if (id >= next_passenger_id) {
-        next_passenger_id = id + 1;
-    }
-    
-    return p;
+    return fromFields(CsvRow(csv_line));
+}
+
+Passenger Passenger::fromFields(const CsvRow& row) {
+    return restore(row.toInt(0), std::string(row.text(1)), std::string(row.text(2)),
+                   std::string(row.text(3)), std::string(row.text(4)),
+                   row.toDouble(5), row.toFlag(6));
 }
@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
 
+class CsvRow;
+
 class Passenger {
 private:
     int passenger_id;
@@ -11,20 +13,25 @@ private:
     double wallet_balance;
     bool is_deleted;
 
+    Passenger(int passenger_id, std::string name, std::string passport_number,
+              std::string national_id, std::string nationality,
+              double wallet_balance, bool is_deleted);
+
 public:
     Passenger(const std::string& name, const std::string& passport_number,
              const std::string& national_id, const std::string& nationality);
     
     // Getters
     int getPassengerId() const { return passenger_id; }
-    std::string getName() const { return name; }
-    std::string getPassportNumber() const { return passport_number; }
-    std::string getNationalId() const { return national_id; }
-    std::string getNationality() const { return nationality; }
+    const std::string& getName() const { return name; }
+    const std::string& getPassportNumber() const { return passport_number; }
+    const std::string& getNationalId() const { return national_id; }
+    const std::string& getNationality() const { return nationality; }
     double getWalletBalance() const { return wallet_balance; }
     bool isDeleted() const { return is_deleted; }
 
     // Setters
+    void setPassengerId(int passenger_id) { this->passenger_id = passenger_id; }
     void setName(const std::string& name) { this->name = name; }
     void setPassportNumber(const std::string& passport_number) { this->passport_number = passport_number; }
     void setNationalId(const std::string& national_id) { this->national_id = national_id; }
@@ -34,5 +41,12 @@ public:
 
     // For file operations
     std::string toCSV() const;
+    // Appends the toCSV() text without a line ending
+    void appendCSV(std::string& out) const;
     static Passenger fromCSV(const std::string& csv_line);
+    static Passenger fromFields(const CsvRow& row);
+    // Rebuilds a stored passenger with its original id
+    static Passenger restore(int passenger_id, std::string name, std::string passport_number,
+                             std::string national_id, std::string nationality,
+                             double wallet_balance, bool is_deleted);
 };
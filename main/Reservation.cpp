@@ -1,27 +1,12 @@
 #include "Reservation.h"
-#include <sstream>
+#include "CsvReader.h"
+#include "CsvWriter.h"
+#include "AirlineExceptions.h"
 #include <ctime>
 #include <stdexcept>
-static int next_reservation_id = 1;
-
-// Define FlightCompletedException
-class FlightCompletedException : public std::exception {
-public:
-    const char* what() const noexcept override {
-        return "Flight has already been completed. Refund not possible.";
-    }
-};
-
-// Define RefundNotAllowedException
-class RefundNotAllowedException : public std::exception {
-public:
-    const char* what() const noexcept override {
-        return "Refund is not allowed less than 24 hours before departure.";
-    }
-};
 
 Reservation::Reservation(int passenger_id, int flight_id, double amount_paid) {
-    this->reservation_id = next_reservation_id++;
+    this->reservation_id = 0;  // Assigned by AirlineSystem when the reservation is added
     this->passenger_id = passenger_id;
     this->flight_id = flight_id;
     this->amount_paid = amount_paid;
@@ -31,6 +16,20 @@ Reservation::Reservation(int passenger_id, int flight_id, double amount_paid) {
     this->is_deleted = false;
 }
 
+Reservation::Reservation(int reservation_id, int passenger_id, int flight_id, double amount_paid,
+                         time_t reservation_time, time_t flight_departure_time,
+                         bool is_cancelled, bool is_deleted)
+    : reservation_id(reservation_id), passenger_id(passenger_id), flight_id(flight_id),
+      amount_paid(amount_paid), reservation_time(reservation_time),
+      flight_departure_time(flight_departure_time), is_cancelled(is_cancelled), is_deleted(is_deleted) {}
+
+Reservation Reservation::restore(int reservation_id, int passenger_id, int flight_id, double amount_paid,
+                                 time_t reservation_time, time_t flight_departure_time,
+                                 bool is_cancelled, bool is_deleted) {
+    return Reservation(reservation_id, passenger_id, flight_id, amount_paid,
+                       reservation_time, flight_departure_time, is_cancelled, is_deleted);
+}
+
 double Reservation::calculateRefundAmount(time_t current_time) const {
     if (current_time > flight_departure_time) {
         throw FlightCompletedException();
@@ -50,52 +49,29 @@ double Reservation::calculateRefundAmount(time_t current_time) const {
 }
 
 std::string Reservation::toCSV() const {
-    std::stringstream ss;
-    ss << reservation_id << ","
-       << passenger_id << ","
-       << flight_id << ","
-       << amount_paid << ","
-       << reservation_time << ","
-       << flight_departure_time << ","
-       << (is_cancelled ? "1" : "0") << ","
-       << (is_deleted ? "1" : "0");
-    return ss.str();
+    std::string line;
+    appendCSV(line);
+    return line;
+}
+
+void Reservation::appendCSV(std::string& out) const {
+    CsvLineWriter(out)
+        .integer(reservation_id)
+        .integer(passenger_id)
+        .integer(flight_id)
+        .number(amount_paid)
+        .integer(reservation_time)
+        .integer(flight_departure_time)
+        .flag(is_cancelled)
+        .flag(is_deleted);
 }
 
 Reservation Reservation::fromCSV(const std::string& csv_line) {
-    std::stringstream ss(csv_line);
-    std::string token;
-    
-    std::getline(ss, token, ',');
-    int res_id = std::stoi(token);
-    
-    std::getline(ss, token, ',');
-    int pass_id = std::stoi(token);
-    
-    std::getline(ss, token, ',');
-    int fl_id = std::stoi(token);
-    
-    std::getline(ss, token, ',');
-    double amount = std::stod(token);
-    
-    Reservation r(pass_id, fl_id, amount);
-    r.reservation_id = res_id;
-    
-    std::getline(ss, token, ',');
-    r.reservation_time = std::stoll(token);
-    
-    std::getline(ss, token, ',');
-    r.flight_departure_time = std::stoll(token);
-    
-    std::getline(ss, token, ',');
-    r.is_cancelled = (token == "1");
-    
-    std::getline(ss, token, ',');
-    r.is_deleted = (token == "1");
-    
-    if (res_id >= next_reservation_id) {
-        next_reservation_id = res_id + 1;
-    }
-    
-    return r;
+    return fromFields(CsvRow(csv_line));
+}
+
+Reservation Reservation::fromFields(const CsvRow& row) {
+    return restore(row.toInt(0), row.toInt(1), row.toInt(2), row.toDouble(3),
+                   static_cast<time_t>(row.toInt64(4)), static_cast<time_t>(row.toInt64(5)),
+                   row.toFlag(6), row.toFlag(7));
 }
@@ -2,6 +2,8 @@
 #include <string>
 #include <ctime>
 
+class CsvRow;
+
 class Reservation {
 private:
     int reservation_id;
@@ -13,6 +15,10 @@ private:
     bool is_cancelled;
     bool is_deleted;
 
+    Reservation(int reservation_id, int passenger_id, int flight_id, double amount_paid,
+                time_t reservation_time, time_t flight_departure_time,
+                bool is_cancelled, bool is_deleted);
+
 public:
     Reservation(int passenger_id, int flight_id, double amount_paid);
 
@@ -27,6 +33,7 @@ public:
     bool isDeleted() const { return is_deleted; }
 
     // Setters
+    void setReservationId(int reservation_id) { this->reservation_id = reservation_id; }
     void setFlightDepartureTime(time_t time) { flight_departure_time = time; } // Add this method
 
     // Operations
@@ -36,5 +43,12 @@ public:
 
     // For file operations
     std::string toCSV() const;
+    // Appends the toCSV() text without a line ending
+    void appendCSV(std::string& out) const;
     static Reservation fromCSV(const std::string& csv_line);
+    static Reservation fromFields(const CsvRow& row);
+    // Rebuilds a stored reservation with its original id
+    static Reservation restore(int reservation_id, int passenger_id, int flight_id, double amount_paid,
+                               time_t reservation_time, time_t flight_departure_time,
+                               bool is_cancelled, bool is_deleted);
 };
@@ -0,0 +1,74 @@
+#include "ReservationColumns.h"
+#include "FilterKernels.h"
+
+uint8_t ReservationColumns::statusOf(const Reservation& reservation) {
+    return static_cast<uint8_t>((reservation.isCancelled() ? CANCELLED : 0) |
+                                (reservation.isDeleted() ? DELETED : 0));
+}
+
+void ReservationColumns::clear() {
+    flight_ids.clear();
+    passenger_ids.clear();
+    amounts.clear();
+    departures.clear();
+    status.clear();
+}
+
+void ReservationColumns::reserve(size_t rows) {
+    flight_ids.reserve(rows);
+    passenger_ids.reserve(rows);
+    amounts.reserve(rows);
+    departures.reserve(rows);
+    status.reserve(rows);
+}
+
+void ReservationColumns::append(const Reservation& reservation, time_t departure) {
+    flight_ids.push_back(reservation.getFlightId());
+    passenger_ids.push_back(reservation.getPassengerId());
+    amounts.push_back(reservation.getAmountPaid());
+    departures.push_back(static_cast<int64_t>(departure));
+    status.push_back(statusOf(reservation));
+}
+
+std::vector<uint64_t> ReservationColumns::selectionBitmap(const ReservationFilter& filter) const {
+    size_t rows = status.size();
+    std::vector<uint64_t> bits = FilterKernels::allRows(rows);
+    uint8_t status_mask = DELETED;
+    uint8_t status_wanted = 0;
+    if (filter.cancelled_only) {
+        status_mask |= CANCELLED;
+        status_wanted |= CANCELLED;
+    }
+    FilterKernels::flagsEqual(status.data(), rows, status_mask, status_wanted, bits.data());
+    if (filter.future_only) {
+        FilterKernels::compareLess(departures.data(), rows, filter.now, false, bits.data());
+    }
+    if (filter.completed_only) {
+        FilterKernels::compareLess(departures.data(), rows, filter.now, true, bits.data());
+    }
+    if (filter.passenger_id != 0) {
+        FilterKernels::idEqual(passenger_ids.data(), rows, filter.passenger_id, bits.data());
+    }
+    if (filter.flight_id != 0) {
+        FilterKernels::idEqual(flight_ids.data(), rows, filter.flight_id, bits.data());
+    }
+    return bits;
+}
+
+std::vector<size_t> ReservationColumns::select(const ReservationFilter& filter) const {
+    std::vector<size_t> slots;
+    FilterKernels::collect(selectionBitmap(filter), slots);
+    return slots;
+}
+
+ReservationTotals ReservationColumns::totals() const {
+    ReservationTotals totals;
+    for (size_t i = 0, rows = status.size(); i < rows; ++i) {
+        uint8_t s = status[i];
+        bool active = s == 0;
+        totals.active += active;
+        totals.cancelled += s == CANCELLED;
+        totals.active_amount += active ? amounts[i] : 0.0;
+    }
+    return totals;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <ctime>
+#include "Reservation.h"
+
+// Which reservations a scan keeps. Deleted reservations are never selected.
+struct ReservationFilter {
+    time_t now = 0;               // flights departing before now are completed
+    bool future_only = false;
+    bool completed_only = false;
+    bool cancelled_only = false;
+    int passenger_id = 0;         // 0 matches every passenger
+    int flight_id = 0;            // 0 matches every flight
+};
+
+struct ReservationTotals {
+    size_t active = 0;
+    size_t cancelled = 0;
+    double active_amount = 0;     // paid for bookings that are not cancelled
+};
+
+// Column-wise copy of the reservation table, one array per field and indexed by
+// the same slots, so scans read only the fields they test instead of whole rows.
+// Departures are the flight's, taken when the row is appended.
+class ReservationColumns {
+private:
+    std::vector<int32_t> flight_ids;
+    std::vector<int32_t> passenger_ids;
+    std::vector<double> amounts;
+    std::vector<int64_t> departures;
+    std::vector<uint8_t> status;
+
+    static uint8_t statusOf(const Reservation& reservation);
+
+public:
+    static constexpr uint8_t CANCELLED = 1;
+    static constexpr uint8_t DELETED = 2;
+
+    void clear();
+    void reserve(size_t rows);
+    void append(const Reservation& reservation, time_t departure);
+    // Picks up a cancel or delete of the row at slot
+    void refresh(size_t slot, const Reservation& reservation) { status[slot] = statusOf(reservation); }
+    size_t size() const { return status.size(); }
+
+    int flightId(size_t slot) const { return flight_ids[slot]; }
+    int passengerId(size_t slot) const { return passenger_ids[slot]; }
+    double amount(size_t slot) const { return amounts[slot]; }
+    time_t departure(size_t slot) const { return static_cast<time_t>(departures[slot]); }
+    bool isCancelled(size_t slot) const { return status[slot] & CANCELLED; }
+    bool isDeleted(size_t slot) const { return status[slot] & DELETED; }
+
+    // One bit per slot, set where the row matches filter; see FilterKernels
+    std::vector<uint64_t> selectionBitmap(const ReservationFilter& filter) const;
+    // Slots matching filter, ascending
+    std::vector<size_t> select(const ReservationFilter& filter) const;
+    ReservationTotals totals() const;
+};
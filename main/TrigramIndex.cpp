@@ -0,0 +1,77 @@
+#include "TrigramIndex.h"
+#include <algorithm>
+
+std::vector<uint32_t> TrigramIndex::trigramsOf(std::initializer_list<std::string_view> fields) {
+    std::vector<uint32_t> trigrams;
+    for (std::string_view field : fields) {
+        for (size_t i = 0; i + MIN_TERM_LENGTH <= field.size(); ++i) {
+            trigrams.push_back(static_cast<uint32_t>(static_cast<unsigned char>(field[i])) << 16 |
+                               static_cast<uint32_t>(static_cast<unsigned char>(field[i + 1])) << 8 |
+                               static_cast<uint32_t>(static_cast<unsigned char>(field[i + 2])));
+        }
+    }
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+    return trigrams;
+}
+
+void TrigramIndex::add(size_t slot, std::initializer_list<std::string_view> fields) {
+    for (uint32_t trigram : trigramsOf(fields)) {
+        auto& slots = postings[trigram];
+        // Rows are mostly added in slot order, so this is usually a push_back
+        if (slots.empty() || slots.back() < slot) {
+            slots.push_back(slot);
+            continue;
+        }
+        auto it = std::lower_bound(slots.begin(), slots.end(), slot);
+        if (it == slots.end() || *it != slot) {
+            slots.insert(it, slot);
+        }
+    }
+}
+
+void TrigramIndex::remove(size_t slot, std::initializer_list<std::string_view> fields) {
+    for (uint32_t trigram : trigramsOf(fields)) {
+        auto posting = postings.find(trigram);
+        if (posting == postings.end()) continue;
+
+        auto& slots = posting->second;
+        auto it = std::lower_bound(slots.begin(), slots.end(), slot);
+        if (it != slots.end() && *it == slot) {
+            slots.erase(it);
+        }
+        if (slots.empty()) {
+            postings.erase(posting);
+        }
+    }
+}
+
+bool TrigramIndex::candidates(std::string_view term, std::vector<size_t>& slots) const {
+    slots.clear();
+    if (term.size() < MIN_TERM_LENGTH) {
+        return false;
+    }
+
+    std::vector<const std::vector<size_t>*> lists;
+    for (uint32_t trigram : trigramsOf({term})) {
+        auto posting = postings.find(trigram);
+        if (posting == postings.end()) {
+            return true;
+        }
+        lists.push_back(&posting->second);
+    }
+
+    // Intersect starting from the rarest trigram so the working set only shrinks
+    std::sort(lists.begin(), lists.end(),
+        [](const std::vector<size_t>* a, const std::vector<size_t>* b) { return a->size() < b->size(); });
+
+    slots = *lists[0];
+    std::vector<size_t> narrowed;
+    for (size_t i = 1; i < lists.size() && !slots.empty(); ++i) {
+        narrowed.clear();
+        std::set_intersection(slots.begin(), slots.end(), lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(narrowed));
+        slots.swap(narrowed);
+    }
+    return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <initializer_list>
+#include <cstdint>
+
+// Inverted index from every 3-byte substring of a row's text fields to the
+// sorted slots of the rows containing it. Queries only narrow candidates;
+// callers still verify each hit against the real fields.
+class TrigramIndex {
+private:
+    std::unordered_map<uint32_t, std::vector<size_t>> postings;
+
+    static std::vector<uint32_t> trigramsOf(std::initializer_list<std::string_view> fields);
+
+public:
+    static constexpr size_t MIN_TERM_LENGTH = 3;
+
+    void add(size_t slot, std::initializer_list<std::string_view> fields);
+    void remove(size_t slot, std::initializer_list<std::string_view> fields);
+    void clear() { postings.clear(); }
+
+    // Slots whose fields contain every trigram of term, ascending.
+    // Returns false when term is shorter than MIN_TERM_LENGTH and cannot be narrowed.
+    bool candidates(std::string_view term, std::vector<size_t>& slots) const;
+};
@@ -47,6 +47,17 @@ int getValidMenuChoice() {
     }
 }
 
+void printImportReport(const ImportReport& report) {
+    std::cout << report.imported << " rows imported, " << report.rejected.size() << " rejected\n";
+    const size_t shown = 20;
+    for (size_t i = 0; i < report.rejected.size() && i < shown; ++i) {
+        std::cout << "  line " << report.rejected[i].row << ": " << report.rejected[i].reason << "\n";
+    }
+    if (report.rejected.size() > shown) {
+        std::cout << "  ... and " << report.rejected.size() - shown << " more\n";
+    }
+}
+
 void passengerMenu(AirlineSystem& system) {
     while (true) {
         clearScreen();
@@ -57,7 +68,8 @@ void passengerMenu(AirlineSystem& system) {
                   << "4. List All Passengers\n"
                   << "5. Edit Passenger\n"
                   << "6. Delete Passenger\n"
-                  << "7. Back to Main Menu\n"
+                  << "7. Import Passengers from CSV\n"
+                  << "8. Back to Main Menu\n"
                   << "Choose an option: ";
 
         int choice = getValidMenuChoice();
@@ -121,12 +133,12 @@ void passengerMenu(AirlineSystem& system) {
                 int id = InputValidator::getValidatedInteger("Enter passenger ID: ", 1, 6);
                 double amount = InputValidator::getValidatedDouble("Enter amount to add: ");
                 
-                auto passenger = system.findPassenger(id);
-                if (passenger) {
-                    passenger->updateWalletBalance(amount);
-                    std::cout << "Balance updated successfully" << std::endl;
-                } else {
-                    std::cout << "Passenger not found" << std::endl;
+                try {
+                    if (system.updateWalletBalance(id, amount)) {
+                        std::cout << "Balance updated successfully" << std::endl;
+                    }
+                } catch (const std::exception& e) {
+                    std::cout << "Error: " << e.what() << std::endl;
                 }
                 break;
             }
@@ -210,7 +222,18 @@ void passengerMenu(AirlineSystem& system) {
                 }
                 break;
             }
-            case 7:
+            case 7: {
+                std::string path;
+                std::cout << "CSV file (name,passport,national ID,nationality per line): ";
+                std::getline(std::cin, path);
+                try {
+                    printImportReport(system.importPassengers(path));
+                } catch (const std::exception& e) {
+                    std::cout << "Error importing passengers: " << e.what() << std::endl;
+                }
+                break;
+            }
+            case 8:
                 return;
         }
         std::cout << "\nPress Enter to continue...";
@@ -226,7 +249,9 @@ void flightMenu(AirlineSystem& system) {
                   << "2. Search Flights\n"
                   << "3. List All Flights\n"
                   << "4. Delete Flight\n"
-                  << "5. Back to Main Menu\n"
+                  << "5. Search by Route\n"
+                  << "6. Import Flights from CSV\n"
+                  << "7. Back to Main Menu\n"
                   << "Choose an option: ";
 
         int choice = getValidMenuChoice();
@@ -285,7 +310,40 @@ void flightMenu(AirlineSystem& system) {
                 }
                 break;
             }
-            case 5:
+            case 5: {
+                std::string origin, destination;
+                std::cout << "Enter origin: ";
+                std::getline(std::cin, origin);
+                std::cout << "Enter destination: ";
+                std::getline(std::cin, destination);
+
+                time_t date = InputValidator::getValidatedDateTime("Enter travel date:");
+                int days_flexible = InputValidator::getValidatedInteger("Flexible days either side (0-9): ", 1, 1);
+
+                auto results = system.searchFlights(origin, destination, date, days_flexible);
+                if (results.empty()) {
+                    std::cout << "No flights found.\n";
+                } else {
+                    std::cout << "\nSearch Results:\n";
+                    for (const Flight* f : results) {
+                        system.displayFlightDetails(*f);
+                        std::cout << "--------------\n";
+                    }
+                }
+                break;
+            }
+            case 6: {
+                std::string path;
+                std::cout << "CSV file (flight number,origin,destination,departure Unix time,seats,price per line): ";
+                std::getline(std::cin, path);
+                try {
+                    printImportReport(system.importFlights(path));
+                } catch (const std::exception& e) {
+                    std::cout << "Error importing flights: " << e.what() << std::endl;
+                }
+                break;
+            }
+            case 7:
                 return;
             default:
                 std::cout << "Invalid option!\n";
@@ -368,7 +426,8 @@ void reportMenu(AirlineSystem& system) {
                   << "6. Daily Flights Report\n"
                   << "7. Future Flights Report\n"
                   << "8. Passenger Trips Report\n"
-                  << "9. Back to Main Menu\n"
+                  << "9. Daily Report Suite\n"
+                  << "10. Back to Main Menu\n"
                   << "Choose an option: ";
 
         int choice = getValidMenuChoice();
@@ -469,7 +528,18 @@ void reportMenu(AirlineSystem& system) {
                     std::cout << "Report generated successfully in " << filename << "\n";
                     break;
                 }
-                case 9:
+                case 9: {
+                    // Every reservation export plus future flights, written in one pass
+                    system.generateReports({ReportSpec::reservations("all_reservations.csv"),
+                                            ReportSpec::reservations("future_reservations.csv", true, false, false),
+                                            ReportSpec::reservations("completed_reservations.csv", false, true, false),
+                                            ReportSpec::reservations("refunded_reservations.csv", false, false, true),
+                                            ReportSpec::futureFlights("future_flights.csv")});
+                    std::cout << "Reports generated successfully in all_reservations.csv, future_reservations.csv,\n"
+                              << "completed_reservations.csv, refunded_reservations.csv and future_flights.csv\n";
+                    break;
+                }
+                case 10:
                     return;
                 default:
                     std::cout << "Invalid option!\n";
@@ -486,6 +556,9 @@ void reportMenu(AirlineSystem& system) {
 int main() {
     try {
         AirlineSystem system;
+        system.setJournaling(true);
+        system.setBackgroundFlush(true);
+        system.setAutoCompact(true);
         
         while (true) {
             clearScreen();
@@ -2,7 +2,32 @@
 #include "catch2/catch.hpp"
 #include "../main/AirlineSystem.h"
 #include "../main/InputValidator.h"
+#include "../main/CsvReader.h"
+#include "../main/CsvWriter.h"
+#include "../main/ThreadPool.h"
+#include "../main/FilterKernels.h"
+#include "../main/OrderedOutput.h"
+#include "../main/LocalTime.h"
 #include <chrono>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+#include <map>
+#include <set>
+
+// Data persists in data/ between runs, so index tests need keys nobody has used yet
+static std::string uniqueDigits(size_t length) {
+    static long long counter = std::chrono::system_clock::now().time_since_epoch().count() / 1000;
+    std::string digits = std::to_string(++counter);
+    while (digits.size() < length) digits = "0" + digits;
+    return digits.substr(digits.size() - length);
+}
 
 TEST_CASE("Passenger Management Tests", "[passenger]") {
     AirlineSystem system;
@@ -37,6 +62,31 @@ TEST_CASE("Passenger Management Tests", "[passenger]") {
     }
 }
 
+TEST_CASE("Passenger Text Search Tests", "[index]") {
+    AirlineSystem system;
+    std::string tag = uniqueDigits(8);
+    std::string passport = "TS" + uniqueDigits(7);
+    int passenger_id = system.addPassenger(Passenger("Trigram " + tag, passport, uniqueDigits(10), "USA"));
+
+    SECTION("Substring Of Any Field") {
+        REQUIRE(system.searchPassengers("ram " + tag).size() == 1);
+        REQUIRE(system.searchPassengers(passport.substr(1)).size() == 1);
+    }
+
+    SECTION("Short Terms Still Match") {
+        REQUIRE_FALSE(system.searchPassengers("T").empty());
+    }
+
+    SECTION("Updates And Deletes Reindex") {
+        system.updatePassenger(passenger_id, "Renamed " + tag, passport, uniqueDigits(10), "USA");
+        REQUIRE(system.searchPassengers("Trigram " + tag).empty());
+        REQUIRE(system.searchPassengers("Renamed " + tag).size() == 1);
+
+        system.deletePassenger(passenger_id);
+        REQUIRE(system.searchPassengers("Renamed " + tag).empty());
+    }
+}
+
 TEST_CASE("Flight Management Tests", "[flight]") {
     AirlineSystem system;
     time_t future_time = std::time(nullptr) + 24*60*60; // Tomorrow
@@ -61,6 +111,127 @@ TEST_CASE("Flight Management Tests", "[flight]") {
         REQUIRE(f.reserveSeat());
         REQUIRE_FALSE(f.reserveSeat()); // No more seats
     }
+
+    SECTION("Seat Inventory Stays Within Capacity") {
+        Flight f("AB123", "New York", "London", future_time, 2, 500.0);
+        REQUIRE(f.getCapacity() == 2);
+        REQUIRE_FALSE(f.cancelSeat()); // Nothing booked yet
+
+        // Many buyers racing for a few seats never oversell
+        Flight hot("AB124", "New York", "London", future_time, 1000, 500.0);
+        std::vector<int> sold(8, 0);
+        std::vector<std::thread> buyers;
+        for (size_t t = 0; t < sold.size(); ++t) {
+            buyers.emplace_back([&hot, &sold, t] {
+                while (hot.reserveSeat()) ++sold[t];
+            });
+        }
+        for (auto& buyer : buyers) buyer.join();
+        REQUIRE(std::accumulate(sold.begin(), sold.end(), 0) == 1000);
+        REQUIRE(hot.getAvailableSeats() == 0);
+    }
+}
+
+TEST_CASE("Primary Key Index Tests", "[index]") {
+    AirlineSystem system;
+    time_t future_time = std::time(nullptr) + 24*60*60;
+
+    SECTION("Lookup Pointers Survive Growth") {
+        Flight f("AB123", "New York", "London", future_time, 100, 500.0);
+        int flight_id = system.addFlight(f);
+        Flight* flight = system.findFlight(flight_id);
+        REQUIRE(flight != nullptr);
+
+        for (int i = 0; i < 50; i++) {
+            system.addFlight(Flight("CD456", "Paris", "Rome", future_time, 10, 100.0));
+        }
+
+        REQUIRE(system.findFlight(flight_id) == flight);
+        REQUIRE(flight->getFlightNumber() == "AB123");
+    }
+
+    SECTION("Unknown And Deleted IDs") {
+        Flight f("AB123", "New York", "London", future_time, 100, 500.0);
+        int flight_id = system.addFlight(f);
+        REQUIRE(system.findPassenger(-1) == nullptr);
+        REQUIRE(system.findReservation(-1) == nullptr);
+
+        system.deleteFlight(flight_id);
+        REQUIRE(system.findFlight(flight_id) == nullptr);
+    }
+}
+
+TEST_CASE("Unique Key Index Tests", "[index]") {
+    AirlineSystem system;
+    std::string national_id = uniqueDigits(10);
+    std::string passport = "UK" + uniqueDigits(7);
+
+    Passenger p("John Doe", passport, national_id, "USA");
+    int passenger_id = system.addPassenger(p);
+
+    SECTION("Exclude Own ID") {
+        REQUIRE(system.isNationalIdTaken(national_id));
+        REQUIRE(system.isPassportNumberTaken(passport));
+        REQUIRE_FALSE(system.isNationalIdTaken(national_id, passenger_id));
+        REQUIRE_FALSE(system.isPassportNumberTaken(passport, passenger_id));
+    }
+
+    SECTION("Update Moves Keys") {
+        std::string new_national_id = uniqueDigits(10);
+        system.updatePassenger(passenger_id, "John Doe", passport, new_national_id, "USA");
+        REQUIRE_FALSE(system.isNationalIdTaken(national_id));
+        REQUIRE(system.isNationalIdTaken(new_national_id));
+    }
+
+    SECTION("Soft Delete Frees Keys") {
+        system.deletePassenger(passenger_id);
+        REQUIRE_FALSE(system.isNationalIdTaken(national_id));
+        REQUIRE_NOTHROW(system.addPassenger(Passenger("Jane Doe", passport, national_id, "USA")));
+    }
+}
+
+TEST_CASE("Departure Index Tests", "[index]") {
+    AirlineSystem system;
+    time_t base = std::time(nullptr) + 30*24*60*60 + std::stoll(uniqueDigits(6));
+
+    int late_id = system.addFlight(Flight("AB123", "New York", "London", base + 10, 10, 100.0));
+    int early_id = system.addFlight(Flight("AB124", "New York", "London", base, 10, 100.0));
+    int outside_id = system.addFlight(Flight("AB125", "New York", "London", base + 20, 10, 100.0));
+
+    std::vector<int> found;
+    for (const Flight* f : system.findFlightsDepartingBetween(base, base + 20)) {
+        int id = f->getFlightId();
+        if (id == late_id || id == early_id || id == outside_id) found.push_back(id);
+    }
+
+    REQUIRE(found == std::vector<int>{early_id, late_id});
+}
+
+TEST_CASE("Route Search Tests", "[index]") {
+    AirlineSystem system;
+    std::string origin = "Origin" + uniqueDigits(8);
+    time_t day = std::time(nullptr) + 10*24*60*60;
+
+    int same_day = system.addFlight(Flight("AB123", origin, "London", day, 10, 100.0));
+    int next_week = system.addFlight(Flight("AB124", origin, "London", day + 7*24*60*60, 10, 100.0));
+    system.addFlight(Flight("AB125", origin, "Paris", day, 10, 100.0));
+
+    SECTION("Exact Day") {
+        auto results = system.searchFlights(origin, "London", day);
+        REQUIRE(results.size() == 1);
+        REQUIRE(results[0]->getFlightId() == same_day);
+    }
+
+    SECTION("Flexible Days") {
+        auto results = system.searchFlights(origin, "London", day, 7);
+        REQUIRE(results.size() == 2);
+        REQUIRE(results[1]->getFlightId() == next_week);
+    }
+
+    SECTION("Deleted Flights Drop Out") {
+        system.deleteFlight(same_day);
+        REQUIRE(system.searchFlights(origin, "London", day).empty());
+    }
 }
 
 TEST_CASE("Reservation Management Tests", "[reservation]") {
@@ -110,6 +281,141 @@ TEST_CASE("Reservation Management Tests", "[reservation]") {
     }
 }
 
+TEST_CASE("Reservation Adjacency Tests", "[index]") {
+    AirlineSystem system;
+    time_t future_time = std::time(nullptr) + 72*60*60;
+
+    Passenger p("John Doe", "AJ" + uniqueDigits(7), uniqueDigits(10), "USA");
+    Flight f("AB123", "New York", "London", future_time, 5, 100.0);
+    int passenger_id = system.addPassenger(p);
+    int flight_id = system.addFlight(f);
+    system.findPassenger(passenger_id)->updateWalletBalance(1000.0);
+    int reservation_id = system.makeReservation(passenger_id, flight_id);
+
+    SECTION("Active Reservations Block Deletes") {
+        REQUIRE_THROWS_AS(system.deletePassenger(passenger_id), AirlineException);
+        REQUIRE_THROWS_AS(system.deleteFlight(flight_id), AirlineException);
+    }
+
+    SECTION("Cancelled Reservations Allow Deletes") {
+        system.cancelReservation(reservation_id);
+        REQUIRE(system.deletePassenger(passenger_id));
+        REQUIRE(system.deleteFlight(flight_id));
+    }
+
+    SECTION("Seat Count Mismatch Refunds Nothing") {
+        // Flight already back at capacity, so there is no reserved seat to release
+        REQUIRE(system.findFlight(flight_id)->cancelSeat());
+        double balance = system.findPassenger(passenger_id)->getWalletBalance();
+        REQUIRE_THROWS_AS(system.cancelReservation(reservation_id), AirlineException);
+        REQUIRE(system.findPassenger(passenger_id)->getWalletBalance() == Approx(balance));
+        REQUIRE_FALSE(system.findReservation(reservation_id)->isCancelled());
+    }
+}
+
+TEST_CASE("Reservation Column Tests", "[index]") {
+    time_t now = std::time(nullptr);
+    ReservationColumns columns;
+    auto add = [&](int id, time_t departure, bool cancelled, bool deleted) {
+        columns.append(Reservation::restore(id, 1, 2, 100.0 * id, now, departure, cancelled, deleted), departure);
+    };
+    add(1, now + 3600, false, false);
+    add(2, now - 3600, true, false);
+    add(3, now - 3600, false, false);
+    add(4, now + 3600, false, true);
+
+    SECTION("Filters Match Row Scans") {
+        ReservationFilter filter;
+        filter.now = now;
+        REQUIRE(columns.select(filter) == std::vector<size_t>{0, 1, 2});
+        filter.future_only = true;
+        REQUIRE(columns.select(filter) == std::vector<size_t>{0});
+        filter.future_only = false;
+        filter.completed_only = true;
+        filter.cancelled_only = true;
+        REQUIRE(columns.select(filter) == std::vector<size_t>{1});
+    }
+
+    SECTION("Id Filters") {
+        columns.append(Reservation::restore(5, 7, 2, 50.0, now, now + 3600, false, false), now + 3600);
+        ReservationFilter filter;
+        filter.passenger_id = 7;
+        REQUIRE(columns.select(filter) == std::vector<size_t>{4});
+        filter.passenger_id = 0;
+        filter.flight_id = 2;
+        REQUIRE(columns.select(filter) == std::vector<size_t>{0, 1, 2, 4});
+    }
+
+    SECTION("Totals Follow Cancellations") {
+        REQUIRE(columns.totals().active == 2);
+        REQUIRE(columns.totals().active_amount == Approx(400.0));
+        Reservation cancelled = Reservation::restore(1, 1, 2, 100.0, now, now + 3600, true, false);
+        columns.refresh(0, cancelled);
+        ReservationTotals totals = columns.totals();
+        REQUIRE(totals.active == 1);
+        REQUIRE(totals.cancelled == 2);
+        REQUIRE(totals.active_amount == Approx(300.0));
+    }
+}
+
+TEST_CASE("Filter Kernel Tests", "[index]") {
+    // Not a multiple of 64, so the vector kernels and the scalar tail both run
+    const size_t rows = 1000;
+    std::vector<int64_t> times(rows);
+    std::vector<uint8_t> flags(rows);
+    std::vector<int32_t> ids(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        times[i] = static_cast<int64_t>((i * 7919) % 1000) - 500;
+        flags[i] = static_cast<uint8_t>((i * 31) % 4);
+        ids[i] = static_cast<int32_t>(i % 13);
+    }
+    auto expected = [&](auto keep) {
+        std::vector<size_t> matches;
+        for (size_t i = 0; i < rows; ++i) {
+            if (keep(i)) matches.push_back(i);
+        }
+        return matches;
+    };
+    auto selected = [](const std::vector<uint64_t>& bits) {
+        std::vector<size_t> matches;
+        FilterKernels::collect(bits, matches);
+        return matches;
+    };
+
+    SECTION("All Rows") {
+        REQUIRE(selected(FilterKernels::allRows(rows)).size() == rows);
+        REQUIRE(FilterKernels::allRows(0).empty());
+    }
+
+    SECTION("Each Kernel Matches A Row Loop") {
+        auto bits = FilterKernels::allRows(rows);
+        FilterKernels::compareLess(times.data(), rows, 0, true, bits.data());
+        REQUIRE(selected(bits) == expected([&](size_t i) { return times[i] < 0; }));
+
+        bits = FilterKernels::allRows(rows);
+        FilterKernels::compareLess(times.data(), rows, 0, false, bits.data());
+        REQUIRE(selected(bits) == expected([&](size_t i) { return times[i] >= 0; }));
+
+        bits = FilterKernels::allRows(rows);
+        FilterKernels::flagsEqual(flags.data(), rows, 3, 1, bits.data());
+        REQUIRE(selected(bits) == expected([&](size_t i) { return flags[i] == 1; }));
+
+        bits = FilterKernels::allRows(rows);
+        FilterKernels::idEqual(ids.data(), rows, 5, bits.data());
+        REQUIRE(selected(bits) == expected([&](size_t i) { return ids[i] == 5; }));
+    }
+
+    SECTION("Kernels Narrow The Same Bitmap") {
+        auto bits = FilterKernels::allRows(rows);
+        FilterKernels::compareLess(times.data(), rows, 100, true, bits.data());
+        FilterKernels::flagsEqual(flags.data(), rows, 2, 0, bits.data());
+        FilterKernels::idEqual(ids.data(), rows, 3, bits.data());
+        REQUIRE(selected(bits) == expected([&](size_t i) {
+            return times[i] < 100 && !(flags[i] & 2) && ids[i] == 3;
+        }));
+    }
+}
+
 TEST_CASE("Refund Policy Tests", "[refund]") {
     AirlineSystem system;
 
@@ -147,6 +453,470 @@ TEST_CASE("Refund Policy Tests", "[refund]") {
     }
 }
 
+static std::string readDataFile(const std::string& name) {
+    std::ifstream file("data/" + name);
+    std::stringstream content;
+    content << file.rdbuf();
+    return content.str();
+}
+
+TEST_CASE("Journal Tests", "[persistence]") {
+    AirlineSystem system;
+    system.setJournaling(true, 1000);
+    std::string national_id = uniqueDigits(10);
+
+    int passenger_id = system.addPassenger(Passenger("John Doe", "JR" + uniqueDigits(7), national_id, "USA"));
+
+    SECTION("Mutations Append Instead Of Rewriting") {
+        REQUIRE(readDataFile("passengers.csv").find(national_id) == std::string::npos);
+        REQUIRE(readDataFile("journal.log").find(national_id) != std::string::npos);
+    }
+
+    SECTION("Journal Replays On Load") {
+        AirlineSystem reloaded;
+        REQUIRE(reloaded.findPassenger(passenger_id) != nullptr);
+        REQUIRE(reloaded.isNationalIdTaken(national_id));
+    }
+
+    SECTION("Checkpoint Folds Journal Into Snapshot") {
+        system.forceSync();
+        REQUIRE(readDataFile("passengers.csv").find(national_id) != std::string::npos);
+        REQUIRE(readDataFile("journal.log").empty());
+    }
+}
+
+TEST_CASE("Dirty Table Tests", "[persistence]") {
+    AirlineSystem system;
+    int passenger_id = system.addPassenger(Passenger("John Doe", "DT" + uniqueDigits(7), uniqueDigits(10), "USA"));
+    REQUIRE_FALSE(system.hasUnsavedChanges());
+
+    auto flights_written = std::filesystem::last_write_time("data/flights.csv");
+    auto reservations_written = std::filesystem::last_write_time("data/reservations.csv");
+
+    system.updateWalletBalance(passenger_id, 250.0);
+
+    REQUIRE_FALSE(system.hasUnsavedChanges());
+    REQUIRE(std::filesystem::last_write_time("data/flights.csv") == flights_written);
+    REQUIRE(std::filesystem::last_write_time("data/reservations.csv") == reservations_written);
+
+    AirlineSystem reloaded;
+    REQUIRE(reloaded.findPassenger(passenger_id)->getWalletBalance() == Approx(250.0));
+}
+
+TEST_CASE("Background Flush Tests", "[persistence]") {
+    std::string national_id = uniqueDigits(10);
+    auto savedWith = [&national_id](const std::string& wallet) {
+        return readDataFile("passengers.csv").find(national_id + ",USA," + wallet + ",0") != std::string::npos;
+    };
+
+    int passenger_id;
+    {
+        AirlineSystem system;
+        system.setBackgroundFlush(true, std::chrono::hours(1), 1000);
+        passenger_id = system.addPassenger(Passenger("Flush Doe", "BF" + uniqueDigits(7), national_id, "USA"));
+        REQUIRE(system.hasUnsavedChanges());
+        REQUIRE_FALSE(savedWith("0"));
+
+        system.forceSync();
+        REQUIRE_FALSE(system.hasUnsavedChanges());
+        REQUIRE(savedWith("0"));
+
+        // One operation is enough to wake the flusher long before the interval
+        system.setBackgroundFlush(true, std::chrono::hours(1), 1);
+        system.updateWalletBalance(passenger_id, 50.0);
+        for (int i = 0; i < 500 && !savedWith("50"); ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        REQUIRE(savedWith("50"));
+    }
+
+    {
+        AirlineSystem system;
+        system.setBackgroundFlush(true, std::chrono::hours(1), 1000);
+        system.updateWalletBalance(passenger_id, 25.0);
+    }
+    REQUIRE(savedWith("75"));
+}
+
+TEST_CASE("Failed Flush Tests", "[persistence]") {
+    std::string national_id = uniqueDigits(10);
+    AirlineSystem system;
+    system.setJournaling(true, 1);
+    system.setBackgroundFlush(true, std::chrono::hours(1), 1000);
+    system.addPassenger(Passenger("Retry Doe", "FF" + uniqueDigits(7), national_id, "USA"));
+
+    // A directory where the staged table should go makes the snapshot write fail
+    std::filesystem::create_directories("data/passengers.csv.tmp/blocked");
+    system.setBackgroundFlush(false);
+    CHECK(system.hasUnsavedChanges());
+    std::filesystem::remove_all("data/passengers.csv.tmp");
+
+    // The retry must still know about the passenger, not just the dirty tables
+    system.setBackgroundFlush(true, std::chrono::hours(1), 1000);
+    system.setBackgroundFlush(false);
+    REQUIRE_FALSE(system.hasUnsavedChanges());
+    REQUIRE(readDataFile("passengers.csv").find(national_id) != std::string::npos);
+}
+
+TEST_CASE("Batch Reservation Tests", "[reservation]") {
+    time_t future_time = std::time(nullptr) + 72*60*60;
+    AirlineSystem system;
+    system.setJournaling(true, 1000000);
+    int rich = system.addPassenger(Passenger("Batch Doe", "BT" + uniqueDigits(7), uniqueDigits(10), "USA"));
+    int poor = system.addPassenger(Passenger("Broke Doe", "BT" + uniqueDigits(7), uniqueDigits(10), "USA"));
+    system.updateWalletBalance(rich, 1000.0);
+    int roomy = system.addFlight(Flight("BT100", "Tehran", "Isfahan", future_time, 10, 100.0));
+    int tight = system.addFlight(Flight("BT101", "Tehran", "Isfahan", future_time, 1, 100.0));
+
+    auto commits = [] {
+        std::string journal = readDataFile("journal.log");
+        size_t count = 0;
+        for (size_t at = journal.find("\nC\n"); at != std::string::npos; at = journal.find("\nC\n", at + 1)) {
+            ++count;
+        }
+        return count;
+    };
+    auto before = commits();
+    auto results = system.makeReservations({
+        {rich, roomy}, {rich, tight}, {rich, tight}, {poor, roomy}, {-1, roomy}, {rich, -1}, {rich, roomy}});
+
+    REQUIRE(results.size() == 7);
+    REQUIRE(results[0].ok());
+    REQUIRE(results[1].ok());
+    REQUIRE(results[2].error == ReservationError::FlightFull);
+    REQUIRE(results[3].error == ReservationError::InsufficientBalance);
+    REQUIRE(results[4].error == ReservationError::PassengerNotFound);
+    REQUIRE(results[5].error == ReservationError::FlightNotFound);
+    REQUIRE(results[6].ok());
+    REQUIRE(results[1].reservation_id == results[0].reservation_id + 1);
+    REQUIRE(results[6].reservation_id == results[1].reservation_id + 1);
+
+    REQUIRE(system.findPassenger(rich)->getWalletBalance() == Approx(700.0));
+    REQUIRE(system.findFlight(roomy)->getAvailableSeats() == 8);
+    REQUIRE(system.findReservation(results[6].reservation_id)->getFlightId() == roomy);
+    REQUIRE(commits() == before + 1);
+}
+
+TEST_CASE("Bulk Import Tests", "[import]") {
+    AirlineSystem system;
+    std::string existing_id = uniqueDigits(10);
+    system.addPassenger(Passenger("Existing Doe", "IM" + uniqueDigits(7), existing_id, "USA"));
+
+    SECTION("Passengers") {
+        std::string first_id = uniqueDigits(10), second_id = uniqueDigits(10);
+        std::string first_passport = "IM" + uniqueDigits(7);
+        {
+            std::ofstream file("import_passengers.csv");
+            file << "Ali Rezaei," << first_passport << "," << first_id << ",IRN\n"
+                 << "Sara Ahmadi,IM" << uniqueDigits(7) << "," << second_id << ",IRN\r\n"
+                 << "\n"
+                 << "Copy Rezaei,IM" << uniqueDigits(7) << "," << first_id << ",IRN\n"   // duplicate in file
+                 << "Old Doe,IM" << uniqueDigits(7) << "," << existing_id << ",USA\n"    // already registered
+                 << "Short Doe,IM" << uniqueDigits(7) << ",12345,USA\n"                  // bad national ID
+                 << "Same Passport," << first_passport << "," << uniqueDigits(10) << ",IRN\n"
+                 << "Missing Fields,IM" << uniqueDigits(7) << "\n";
+        }
+        ImportReport report = system.importPassengers("import_passengers.csv");
+
+        REQUIRE(report.imported == 2);
+        REQUIRE(report.rejected.size() == 5);
+        REQUIRE(report.rejected[0].row == 4);
+        REQUIRE(report.rejected[0].reason == "National ID already exists");
+        REQUIRE(report.rejected[2].reason == "Invalid input for: national ID");
+        REQUIRE(report.rejected[3].reason == "Passport number already exists");
+        REQUIRE(report.rejected[4].row == 8);
+        REQUIRE(system.isNationalIdTaken(first_id));
+        REQUIRE(system.isNationalIdTaken(second_id));
+        REQUIRE(readDataFile("passengers.csv").find(second_id) != std::string::npos);
+    }
+
+    SECTION("Flights") {
+        time_t departure = std::time(nullptr) + 72*60*60;
+        std::string origin = "Import" + uniqueDigits(6);
+        {
+            std::ofstream file("import_flights.csv");
+            file << "IR101," << origin << ",Kish," << departure << ",150,95.5\n"
+                 << "IR1," << origin << ",Kish," << departure << ",150,95.5\n"       // bad flight number
+                 << "IR102," << origin << ",Kish," << departure << ",-3,95.5\n"      // negative seats
+                 << "IR103," << origin << ",Kish,tomorrow,150,95.5\n"                // not a number
+                 << "IR104," << origin << ",Kish," << departure << ",20,80\n"
+                 << "IR105," << origin << ",Kish," << departure - 96*60*60 << ",20,80\n";  // already departed
+        }
+        ImportReport report = system.importFlights("import_flights.csv");
+
+        REQUIRE(report.imported == 2);
+        REQUIRE(report.rejected.size() == 4);
+        REQUIRE(report.rejected[0].reason == "Invalid input for: flight number");
+        REQUIRE(report.rejected[1].reason == "Invalid input for: available seats");
+        REQUIRE(report.rejected[2].row == 4);
+        REQUIRE(report.rejected[3].row == 6);
+        REQUIRE(report.rejected[3].reason == "Invalid input for: departure time");
+        auto found = system.searchFlights(origin, "Kish", departure);
+        REQUIRE(found.size() == 2);
+        REQUIRE(found[1]->getCapacity() == 20);
+    }
+
+    SECTION("Missing File") {
+        REQUIRE_THROWS_AS(system.importFlights("no_such_import.csv"), FileOperationException);
+    }
+}
+
+TEST_CASE("Concurrent Booking Tests", "[concurrency]") {
+    const int threads = 4;
+    const int bookings = 25;
+    const int shared_seats = 10;
+    time_t future_time = std::time(nullptr) + 72*60*60;
+
+    AirlineSystem system;
+    system.setDurability(Durability::None);
+    system.setJournaling(true);
+    system.setBackgroundFlush(true);
+
+    int shared_flight = system.addFlight(Flight("CC100", "Tehran", "Mashhad", future_time, shared_seats, 10.0));
+    std::vector<int> passenger_ids, flight_ids;
+    for (int t = 0; t < threads; ++t) {
+        passenger_ids.push_back(system.addPassenger(
+            Passenger("Thread Doe", "CT" + uniqueDigits(7), uniqueDigits(10), "USA")));
+        system.updateWalletBalance(passenger_ids.back(), 10000.0);
+        flight_ids.push_back(system.addFlight(Flight("CC" + std::to_string(t), "Tehran", "Shiraz", future_time, bookings, 10.0)));
+    }
+
+    std::vector<int> shared_won(threads, 0);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            for (int i = 0; i < bookings; ++i) {
+                system.makeReservation(passenger_ids[t], flight_ids[t]);
+                try {
+                    system.makeReservation(passenger_ids[t], shared_flight);
+                    ++shared_won[t];
+                } catch (const AirlineException&) {
+                    // Sold out
+                }
+            }
+        });
+    }
+    for (auto& worker : pool) worker.join();
+
+    int won = 0;
+    for (int t = 0; t < threads; ++t) {
+        won += shared_won[t];
+        REQUIRE(system.findFlight(flight_ids[t])->getAvailableSeats() == 0);
+        REQUIRE(system.findPassenger(passenger_ids[t])->getWalletBalance() ==
+                Approx(10000.0 - 10.0 * (bookings + shared_won[t])));
+    }
+    REQUIRE(won == shared_seats);
+    REQUIRE(system.findFlight(shared_flight)->getAvailableSeats() == 0);
+}
+
+TEST_CASE("Concurrent Report Tests", "[concurrency]") {
+    const int threads = 3;
+    const int bookings = 50;
+    time_t future_time = std::time(nullptr) + 72*60*60;
+
+    AirlineSystem system;
+    system.setDurability(Durability::None);
+    system.setJournaling(true, 1000000);
+    int flight_id = system.addFlight(Flight("CR100", "Tehran", "Ahvaz", future_time, threads * bookings, 10.0));
+    std::vector<int> passenger_ids;
+    for (int t = 0; t < threads; ++t) {
+        passenger_ids.push_back(system.addPassenger(
+            Passenger("Report Doe", "CR" + uniqueDigits(7), uniqueDigits(10), "USA")));
+        system.updateWalletBalance(passenger_ids.back(), 10000.0);
+    }
+
+    // Reports only take the shared catalog lock, so bookings and cancellations keep going
+    std::atomic<bool> booking{true};
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            for (int i = 0; i < bookings; ++i) {
+                int reservation_id = system.makeReservation(passenger_ids[t], flight_id);
+                if (i % 2 == 0) system.cancelReservation(reservation_id);
+            }
+        });
+    }
+    std::thread reporter([&] {
+        while (booking) {
+            system.generateReports({ReportSpec::reservations("concurrent_reservations.csv"),
+                                    ReportSpec::flightPassengers("concurrent_passengers.csv", flight_id)});
+            system.generatePassengerReport(passenger_ids[0]);
+            system.generatePassengerTripsReport("concurrent_trips.csv", passenger_ids[1]);
+        }
+    });
+    for (auto& worker : pool) worker.join();
+    booking = false;
+    reporter.join();
+
+    system.generateFlightPassengersReport("concurrent_passengers.csv", flight_id);
+    std::ifstream report("concurrent_passengers.csv");
+    std::string line;
+    size_t confirmed = 0, cancelled = 0;
+    while (std::getline(report, line)) {
+        if (line.find(",Confirmed") != std::string::npos) ++confirmed;
+        if (line.find(",Cancelled") != std::string::npos) ++cancelled;
+    }
+    REQUIRE(confirmed == threads * bookings / 2);
+    REQUIRE(cancelled == threads * bookings / 2);
+}
+
+TEST_CASE("Concurrent Journal Tests", "[concurrency]") {
+    const int threads = 4;
+    const int bookings = 2000;
+    time_t future_time = std::time(nullptr) + 72*60*60;
+
+    AirlineSystem system;
+    system.setDurability(Durability::None);
+    system.setJournaling(true, 1000000);
+    int flight_id = system.addFlight(Flight("CJ100", "Tehran", "Tabriz", future_time, threads * bookings, 1.0));
+    std::vector<int> passenger_ids;
+    for (int t = 0; t < threads; ++t) {
+        passenger_ids.push_back(system.addPassenger(
+            Passenger("Journal Doe", "CJ" + uniqueDigits(7), uniqueDigits(10), "USA")));
+        system.updateWalletBalance(passenger_ids.back(), 10000.0);
+    }
+    size_t journal_start = readDataFile("journal.log").size();
+
+    // Every booking's autoSave races the others for the pending journal lines
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            for (int i = 0; i < bookings; ++i) {
+                system.makeReservation(passenger_ids[t], flight_id);
+            }
+        });
+    }
+    for (auto& worker : pool) worker.join();
+
+    // Replay the records one commit at a time, as a crash after any of them would
+    std::map<int, double> wallets;
+    std::map<int, std::set<int>> booked;
+    for (int id : passenger_ids) wallets[id] = 10000.0;
+    std::istringstream journal(readDataFile("journal.log").substr(journal_start));
+    std::vector<std::string> record;
+    size_t records = 0, orphaned = 0;
+    for (std::string line; std::getline(journal, line);) {
+        if (line != "C") {
+            record.push_back(line);
+            continue;
+        }
+        for (const auto& row : record) {
+            if (row[0] == 'P') {
+                Passenger passenger = Passenger::fromCSV(row.substr(2));
+                wallets[passenger.getPassengerId()] = passenger.getWalletBalance();
+            } else if (row[0] == 'R') {
+                Reservation reservation = Reservation::fromCSV(row.substr(2));
+                booked[reservation.getPassengerId()].insert(reservation.getReservationId());
+            }
+        }
+        record.clear();
+        ++records;
+        for (int id : passenger_ids) {
+            if (wallets[id] != Approx(10000.0 - 1.0 * booked[id].size())) ++orphaned;
+        }
+    }
+
+    REQUIRE(records > 0);
+    REQUIRE(record.empty());
+    REQUIRE(orphaned == 0);
+    for (int id : passenger_ids) {
+        REQUIRE(booked[id].size() == static_cast<size_t>(bookings));
+    }
+}
+
+TEST_CASE("Binary Snapshot Tests", "[persistence]") {
+    std::string national_id = uniqueDigits(10);
+    time_t future_time = std::time(nullptr) + 72*60*60;
+    int passenger_id, flight_id, reservation_id;
+    {
+        AirlineSystem system(SnapshotFormat::Binary);
+        passenger_id = system.addPassenger(Passenger("Binary Doe", "BS" + uniqueDigits(7), national_id, "USA"));
+        flight_id = system.addFlight(Flight("AB123", "New York", "London", future_time, 3, 120.5));
+        system.updateWalletBalance(passenger_id, 500.0);
+        reservation_id = system.makeReservation(passenger_id, flight_id);
+    }
+
+    SECTION("Round Trip") {
+        AirlineSystem reloaded(SnapshotFormat::Binary);
+        REQUIRE(reloaded.findPassenger(passenger_id)->getName() == "Binary Doe");
+        REQUIRE(reloaded.findPassenger(passenger_id)->getWalletBalance() == Approx(379.5));
+        REQUIRE(reloaded.findFlight(flight_id)->getAvailableSeats() == 2);
+        REQUIRE(reloaded.findFlight(flight_id)->getDepartureTime() == future_time);
+        REQUIRE(reloaded.findReservation(reservation_id)->getFlightDepartureTime() == future_time);
+        REQUIRE(reloaded.isNationalIdTaken(national_id));
+    }
+
+    SECTION("Convert To CSV") {
+        FileManager files;
+        files.convertBinaryToCsv();
+        AirlineSystem reloaded;
+        REQUIRE(reloaded.findReservation(reservation_id) != nullptr);
+    }
+}
+
+TEST_CASE("Local Time Tests", "[time]") {
+    // Every 7 hours and 13 minutes over a few years, so the samples cross DST changes at odd times
+    std::vector<time_t> samples;
+    for (time_t t = 1600000000; t < 1700000000; t += 7 * 3600 + 13 * 60) samples.push_back(t);
+    samples.push_back(0);
+    samples.push_back(951782400);   // 2000-02-29 00:00 UTC
+
+    auto matchesLibc = [&samples]() {
+        for (time_t t : samples) {
+            tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &t);
+#else
+            localtime_r(&t, &local);
+#endif
+            char expected_date[11], expected_time[9], date[11], time_str[9];
+            std::strftime(expected_date, sizeof(expected_date), "%Y-%m-%d", &local);
+            std::strftime(expected_time, sizeof(expected_time), "%H:%M:%S", &local);
+            char expected_ctime[64], ctime_str[26];
+            std::strftime(expected_ctime, sizeof(expected_ctime), "%a %b %e %H:%M:%S %Y\n", &local);
+            if (std::string(LocalTime::formatDate(t, date)) != expected_date ||
+                std::string(LocalTime::formatTime(t, time_str)) != expected_time ||
+                std::string(LocalTime::formatCtime(t, ctime_str)) != expected_ctime) {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    SECTION("Formats Match strftime") {
+        REQUIRE(matchesLibc());
+    }
+
+#ifndef _WIN32
+    SECTION("Zones With DST And Half-Hour Offsets") {
+        std::string saved = std::getenv("TZ") ? std::getenv("TZ") : "";
+        bool had_tz = std::getenv("TZ") != nullptr;
+        for (const char* zone : {"EST5EDT,M3.2.0,M11.1.0", "NST3:30NDT,M3.2.0,M11.1.0", "IST-5:30"}) {
+            setenv("TZ", zone, 1);
+            tzset();
+            LocalTime::clearCache();
+            INFO(zone);
+            REQUIRE(matchesLibc());
+        }
+        if (had_tz) setenv("TZ", saved.c_str(), 1); else unsetenv("TZ");
+        tzset();
+        LocalTime::clearCache();
+    }
+#endif
+
+    SECTION("Day Buckets") {
+        time_t noon = LocalTime::dayStart(1700000000) + 12 * 3600;
+        REQUIRE(LocalTime::dayNumber(noon) == LocalTime::dayNumber(LocalTime::dayStart(noon)));
+        REQUIRE(LocalTime::dayNumber(LocalTime::dayStart(noon, 1)) == LocalTime::dayNumber(noon) + 1);
+        REQUIRE(LocalTime::dayNumber(LocalTime::dayStart(noon, 1) - 1) == LocalTime::dayNumber(noon));
+
+        AirlineSystem system;
+        Flight flight("LT100", "Ahvaz", "Sari", noon, 5, 10.0);
+        REQUIRE(system.isFlightOnDate(flight, LocalTime::dayStart(noon)));
+        REQUIRE_FALSE(system.isFlightOnDate(flight, LocalTime::dayStart(noon, 1)));
+    }
+}
+
 TEST_CASE("Input Validation Tests", "[validation]") {
     SECTION("Validate National ID") {
         REQUIRE(InputValidator::validateNationalId("1234567890"));
@@ -165,7 +935,324 @@ TEST_CASE("Input Validation Tests", "[validation]") {
     }
 }
 
-منظTEST_CASE("Report Generation Tests", "[reports]") {
+TEST_CASE("CSV Tokenizer Tests", "[csv]") {
+    SECTION("Parse Entity Rows") {
+        Flight f = Flight::fromCSV("7,AB123,New York,London,1766249400,12,20.50,0\r");
+        REQUIRE(f.getFlightId() == 7);
+        REQUIRE(f.getDestination() == "London");
+        REQUIRE(f.getTicketPrice() == Approx(20.5));
+        REQUIRE_FALSE(f.isDeleted());
+    }
+
+    SECTION("Report Row And Column") {
+        const std::string data = "1,2,3,10.5,0,0,0,0\n\n2,x,3,10.5,0,0,0,0\n";
+        CsvReader reader(data.data(), data.size());
+        CsvRow row;
+        REQUIRE(reader.next(row));
+        REQUIRE_NOTHROW(Reservation::fromFields(row));
+        REQUIRE(reader.next(row));
+        REQUIRE_THROWS_WITH(Reservation::fromFields(row), Catch::Contains("row 3, column 2"));
+        REQUIRE_FALSE(reader.next(row));
+    }
+
+    SECTION("Missing Fields") {
+        REQUIRE_THROWS_AS(Passenger::fromCSV("1,John Doe"), CsvParseException);
+    }
+}
+
+TEST_CASE("CSV Writer Tests", "[csv]") {
+    SECTION("Numbers Match Stream Formatting") {
+        for (double value : {0.0, -0.0, 0.1, 125.5, 99.999999, 1234567.0, 1e-7, -42.25, 1e300}) {
+            std::ostringstream general;
+            general << value;
+            std::ostringstream fixed;
+            fixed << std::fixed << std::setprecision(2) << value;
+
+            std::string line;
+            CsvLineWriter(line).number(value).fixed(value, 2);
+            REQUIRE(line == general.str() + "," + fixed.str());
+        }
+    }
+
+    SECTION("Entity Rows Round Trip") {
+        const std::string row = "7,AB123,New York,London,1766249400,12,20.50,0";
+        REQUIRE(Flight::fromCSV(row).toCSV() == row);
+        REQUIRE_FALSE(Flight::fromCSV(row).hasCapacity());
+        const std::string with_capacity = row + ",20";
+        REQUIRE(Flight::fromCSV(with_capacity).getCapacity() == 20);
+        REQUIRE(Flight::fromCSV(with_capacity).toCSV() == with_capacity);
+
+        std::string buffer = "R,";
+        Reservation::fromCSV("3,1,7,1.23457e+06,1700000000,1766249400,1,0").appendCSV(buffer);
+        REQUIRE(buffer == "R,3,1,7,1.23457e+06,1700000000,1766249400,1,0");
+    }
+}
+
+TEST_CASE("Id Allocation Tests", "[persistence]") {
+    SECTION("Temporaries Do Not Consume Ids") {
+        AirlineSystem system;
+        int first = system.addPassenger(Passenger("Id Doe", "ID" + uniqueDigits(7), uniqueDigits(10), "USA"));
+        Passenger unsaved("Temp Doe", "ID" + uniqueDigits(7), uniqueDigits(10), "USA");
+        Passenger::fromCSV("999999,Parsed Doe,XY1234567,1234567890,USA,0,0");
+        REQUIRE(unsaved.getPassengerId() == 0);
+        int second = system.addPassenger(Passenger("Id Doe", "ID" + uniqueDigits(7), uniqueDigits(10), "USA"));
+        REQUIRE(second == first + 1);
+    }
+
+    SECTION("Concurrent Allocation Has No Gaps") {
+        IdAllocator ids;
+        ids.observe(41);
+        std::vector<std::vector<int>> taken(4);
+        std::vector<std::thread> threads;
+        for (auto& mine : taken) {
+            threads.emplace_back([&ids, &mine] {
+                for (int i = 0; i < 1000; ++i) mine.push_back(ids.next());
+                int block = ids.reserveBlock(10);
+                for (int i = 0; i < 10; ++i) mine.push_back(block + i);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        std::vector<int> all;
+        for (const auto& mine : taken) all.insert(all.end(), mine.begin(), mine.end());
+        std::sort(all.begin(), all.end());
+        REQUIRE(all.front() == 42);
+        REQUIRE(all.back() == 42 + int(all.size()) - 1);
+        REQUIRE(std::adjacent_find(all.begin(), all.end()) == all.end());
+    }
+
+    SECTION("Thread Blocks Skip But Never Repeat Ids") {
+        IdAllocator ids(16);
+        ids.observe(41);
+        std::vector<std::vector<int>> taken(4);
+        std::vector<std::thread> threads;
+        for (auto& mine : taken) {
+            threads.emplace_back([&ids, &mine] {
+                for (int i = 0; i < 1000; ++i) mine.push_back(ids.next());
+            });
+        }
+        for (auto& thread : threads) thread.join();
+
+        std::vector<int> all;
+        for (const auto& mine : taken) {
+            // Each thread counts up through its own blocks
+            REQUIRE(std::is_sorted(mine.begin(), mine.end()));
+            REQUIRE(mine[1] == mine[0] + 1);
+            all.insert(all.end(), mine.begin(), mine.end());
+        }
+        std::sort(all.begin(), all.end());
+        REQUIRE(all.front() >= 42);
+        REQUIRE(std::adjacent_find(all.begin(), all.end()) == all.end());
+        REQUIRE(ids.peek() > all.back());
+
+        // Moving the counter past a cached block does not hand its ids out again
+        int before = ids.next();
+        ids.observe(ids.peek() + 100);
+        REQUIRE(ids.next() == before + 1);
+        REQUIRE(ids.peek() > before + 100);
+    }
+
+    SECTION("Sequences Are Saved With The Snapshot") {
+        int passenger_id;
+        {
+            AirlineSystem system;
+            passenger_id = system.addPassenger(Passenger("Seq Doe", "SQ" + uniqueDigits(7), uniqueDigits(10), "USA"));
+        }
+        FileManager files;
+        REQUIRE(files.loadSequences().passenger == passenger_id + 1);
+    }
+
+    SECTION("Restarts Continue Reservation Ids") {
+        int passenger_id;
+        int flight_id;
+        {
+            AirlineSystem system;
+            passenger_id = system.addPassenger(Passenger("Seq Doe", "SQ" + uniqueDigits(7), uniqueDigits(10), "USA"));
+            flight_id = system.addFlight(Flight("SQ100", "Tehran", "Rasht", std::time(nullptr) + 24*60*60, 10, 10.0));
+            system.updateWalletBalance(passenger_id, 100.0);
+        }
+        std::vector<int> ids;
+        for (int run = 0; run < 3; ++run) {
+            // A fresh system each time, so every booking starts a new thread block
+            AirlineSystem system;
+            ids.push_back(system.makeReservation(passenger_id, flight_id));
+        }
+        REQUIRE(ids[1] == ids[0] + 1);
+        REQUIRE(ids[2] == ids[1] + 1);
+        FileManager files;
+        REQUIRE(files.loadSequences().reservation == ids[2] + 1);
+    }
+}
+
+TEST_CASE("Compaction Tests", "[persistence]") {
+    AirlineSystem system;
+    time_t future_time = std::time(nullptr) + 72*60*60;
+    // Earlier runs leave tombstones behind; whatever compaction has to keep is the baseline
+    system.compact();
+    StorageStats baseline = system.storageStats();
+
+    int booked = system.addPassenger(Passenger("Kept Doe", "CP" + uniqueDigits(7), uniqueDigits(10), "USA"));
+    int flight_id = system.addFlight(Flight("CP100", "Shiraz", "Rasht", future_time, 5, 100.0));
+    system.updateWalletBalance(booked, 1000.0);
+    system.cancelReservation(system.makeReservation(booked, flight_id));
+    int unbooked = system.addPassenger(Passenger("Gone Doe", "CP" + uniqueDigits(7), uniqueDigits(10), "USA"));
+
+    SECTION("Drops Unreferenced Tombstones") {
+        system.deletePassenger(unbooked);
+        system.deletePassenger(booked);
+        REQUIRE(system.storageStats().passengers.dead == baseline.passengers.dead + 2);
+
+        // The cancelled reservation still refers to the booked passenger
+        REQUIRE(system.compact() == 1);
+        StorageStats after = system.storageStats();
+        REQUIRE(after.passengers.dead == baseline.passengers.dead + 1);
+        REQUIRE(after.passengers.live == baseline.passengers.live);
+        REQUIRE(system.findPassenger(unbooked) == nullptr);
+        REQUIRE(system.findFlight(flight_id) != nullptr);
+    }
+
+    SECTION("Rewrites Storage Without Reusing Ids") {
+        system.deletePassenger(unbooked);
+        system.compact();
+
+        AirlineSystem reloaded;
+        StorageStats stats = reloaded.storageStats();
+        REQUIRE(stats.passengers.dead == baseline.passengers.dead);
+        REQUIRE(stats.passengers.live == baseline.passengers.live + 1);
+        REQUIRE(reloaded.findPassenger(booked) != nullptr);
+        int next = reloaded.addPassenger(Passenger("Next Doe", "CP" + uniqueDigits(7), uniqueDigits(10), "USA"));
+        REQUIRE(next > unbooked);
+    }
+
+    SECTION("Loaded Tombstones Count Toward The Threshold") {
+        system.deletePassenger(unbooked);
+        AirlineSystem reloaded;
+        REQUIRE(reloaded.storageStats().passengers.dead == baseline.passengers.dead + 1);
+
+        reloaded.setAutoCompact(true, 0.0, 1);
+        REQUIRE(reloaded.storageStats().passengers.dead == baseline.passengers.dead);
+        REQUIRE(reloaded.findPassenger(unbooked) == nullptr);
+    }
+
+    SECTION("Threshold Triggers On Delete") {
+        system.setAutoCompact(true, 0.0, 2);
+        system.deletePassenger(unbooked);
+        REQUIRE(system.storageStats().passengers.dead == baseline.passengers.dead + 1);
+        system.deleteFlight(system.addFlight(Flight("CP101", "Shiraz", "Rasht", future_time, 5, 100.0)));
+        StorageStats after = system.storageStats();
+        REQUIRE(after.passengers.dead == baseline.passengers.dead);
+        REQUIRE(after.flights.dead == baseline.flights.dead);
+    }
+}
+
+TEST_CASE("Parallel Load Tests", "[persistence]") {
+    std::string original = readDataFile("reservations.csv");
+    std::string rows;
+    for (int id = 1; id <= 60000; ++id) {
+        rows += std::to_string(id) + ",1,1,125.5,1700000000,1766249400,0,0\n";
+    }
+
+    auto loadWith = [](const std::string& content, ThreadPool* pool) {
+        std::ofstream("data/reservations.csv", std::ios::binary | std::ios::trunc) << content;
+        FileManager manager;
+        manager.setThreadPool(pool);
+        return manager.loadReservations();
+    };
+
+    ThreadPool pool(4);
+    SECTION("Chunks Merge In File Order") {
+        auto parallel = loadWith(rows, &pool);
+        REQUIRE(parallel.size() == 60000);
+        bool in_order = true;
+        for (size_t i = 0; i < parallel.size(); ++i) {
+            in_order = in_order && parallel[i].getReservationId() == int(i) + 1;
+        }
+        REQUIRE(in_order);
+        REQUIRE(loadWith(rows, nullptr).size() == parallel.size());
+    }
+
+    SECTION("Errors Report File Row Numbers") {
+        std::string broken = rows + "60001,x,1,125.5,1700000000,1766249400,0,0\n";
+        REQUIRE_THROWS_WITH(loadWith(broken, &pool), Catch::Contains("row 60001, column 2"));
+    }
+
+    std::ofstream("data/reservations.csv", std::ios::binary | std::ios::trunc) << original;
+}
+
+TEST_CASE("Atomic Commit Tests", "[persistence]") {
+    std::string original = readDataFile("reservations.csv");
+    const std::string first = "1,1,1,125.5,1700000000,1766249400,0,0\n";
+    const std::string second = "2,1,1,125.5,1700000000,1766249400,0,0\n";
+    auto writeDataFile = [](const std::string& name, const std::string& content) {
+        std::ofstream("data/" + name, std::ios::binary | std::ios::trunc) << content;
+    };
+    writeDataFile("reservations.csv", first);
+    FileManager manager;
+
+    SECTION("Staged Tables Replace Live Files Together") {
+        std::deque<Reservation> reservations = {Reservation::fromCSV(first), Reservation::fromCSV(second)};
+        manager.beginCommit();
+        manager.saveReservations(reservations, 1);
+        REQUIRE(readDataFile("reservations.csv") == first);
+        REQUIRE(std::filesystem::exists("data/reservations.csv.tmp"));
+
+        manager.commitTables();
+        REQUIRE(readDataFile("reservations.csv") == first + second);
+        REQUIRE_FALSE(std::filesystem::exists("data/reservations.csv.tmp"));
+        REQUIRE_FALSE(std::filesystem::exists("data/commit.intent"));
+    }
+
+    SECTION("Recovery Rolls A Committed Append Forward") {
+        // Crashed part way through appending the second row
+        writeDataFile("reservations.csv", first + second.substr(0, 10));
+        writeDataFile("reservations.csv.tmp", second);
+        writeDataFile("commit.intent", "append reservations.csv " + std::to_string(first.size()) + "\n");
+
+        manager.recoverCommit();
+        REQUIRE(readDataFile("reservations.csv") == first + second);
+        REQUIRE_FALSE(std::filesystem::exists("data/commit.intent"));
+    }
+
+    SECTION("Recovery Discards Uncommitted Tables") {
+        writeDataFile("reservations.csv.tmp", second);
+        manager.recoverCommit();
+        REQUIRE(readDataFile("reservations.csv") == first);
+        REQUIRE_FALSE(std::filesystem::exists("data/reservations.csv.tmp"));
+    }
+
+    writeDataFile("reservations.csv", original);
+}
+
+TEST_CASE("Ordered Output Tests", "[reports]") {
+    ThreadPool pool(4);
+    const size_t rows = 10 * MIN_PARALLEL_ROWS + 7;
+    auto format = [](std::ostream& out, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            out << i << "," << i / 3.0 << "\n";
+        }
+    };
+    auto render = [&](ThreadPool* workers) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2);
+        writeOrdered(out, workers, rows, format);
+        return out.str();
+    };
+
+    SECTION("Matches A Sequential Pass") {
+        std::string sequential = render(nullptr);
+        REQUIRE(sequential.find("3,1.00\n") != std::string::npos);
+        REQUIRE(render(&pool) == sequential);
+    }
+
+    SECTION("Failures Reach The Caller") {
+        std::ostringstream out;
+        REQUIRE_THROWS_AS(writeOrdered(out, &pool, rows, [](std::ostream&, size_t begin, size_t) {
+            if (begin > 0) throw std::runtime_error("slice failed");
+        }), std::runtime_error);
+    }
+}
+
+TEST_CASE("Report Generation Tests", "[reports]") {
     AirlineSystem system;
     time_t future_time = std::time(nullptr) + 24*60*60;
 
@@ -185,3 +1272,49 @@ TEST_CASE("Input Validation Tests", "[validation]") {
         REQUIRE_NOTHROW(system.generateReservationsReport("test_report.csv", true, false, false));
     }
 }
+
+TEST_CASE("Report Batch Tests", "[reports]") {
+    AirlineSystem system;
+    time_t future_time = std::time(nullptr) + 72*60*60;
+    int passenger_id = system.addPassenger(Passenger("Batch Doe", "RB" + uniqueDigits(7), uniqueDigits(10), "USA"));
+    system.updateWalletBalance(passenger_id, 1000.0);
+    int first = system.addFlight(Flight("RB100", "Tabriz", "Kish", future_time, 5, 100.0));
+    int second = system.addFlight(Flight("RB200", "Kish", "Tabriz", future_time + 3600, 5, 80.0));
+    system.makeReservation(passenger_id, first);
+    system.cancelReservation(system.makeReservation(passenger_id, second));
+    system.makeReservation(passenger_id, second);
+
+    auto contents = [](const std::string& filename) {
+        std::ifstream file(filename, std::ios::binary);
+        std::stringstream text;
+        text << file.rdbuf();
+        return text.str();
+    };
+
+    SECTION("Files Match The Single Reports") {
+        system.generateReservationsReport("single_all.csv");
+        system.generateReservationsReport("single_refunded.csv", false, false, true);
+        system.generateFutureFlightsReport("single_future.csv");
+        system.generateFlightPassengersReport("single_second.csv", second);
+        system.generateReports({ReportSpec::reservations("batch_all.csv"),
+                                ReportSpec::reservations("batch_refunded.csv", false, false, true),
+                                ReportSpec::futureFlights("batch_future.csv"),
+                                ReportSpec::flightPassengers("batch_second.csv", second),
+                                ReportSpec::flightPassengers("batch_first.csv", first)});
+
+        REQUIRE(contents("batch_all.csv") == contents("single_all.csv"));
+        REQUIRE(contents("batch_refunded.csv") == contents("single_refunded.csv"));
+        REQUIRE(contents("batch_future.csv") == contents("single_future.csv"));
+        REQUIRE(contents("batch_second.csv") == contents("single_second.csv"));
+        REQUIRE(contents("batch_second.csv").find("Cancelled") != std::string::npos);
+        REQUIRE(contents("batch_first.csv").find("Confirmed") != std::string::npos);
+    }
+
+    SECTION("Unknown Flight Writes Nothing") {
+        std::remove("batch_none.csv");
+        REQUIRE_THROWS_AS(system.generateReports({ReportSpec::reservations("batch_none.csv"),
+                                                  ReportSpec::flightPassengers("batch_missing.csv", -1)}),
+                          FlightNotFoundException);
+        REQUIRE_FALSE(std::filesystem::exists("batch_none.csv"));
+    }
+}